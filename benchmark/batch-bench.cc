@@ -0,0 +1,85 @@
+#include "dinject.h"
+#include "plan.h"
+#include "bench.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+struct Particle {
+  double x;
+  double y;
+  double life;
+  std::int32_t color;
+  std::string texture;
+
+  Particle() : x(), y(), life(), color(), texture() {}
+
+  void SetX      ( double v )             { x = v; }
+  void SetY      ( double v )             { y = v; }
+  void SetLife   ( double v )             { life = v; }
+  void SetColor  ( std::int32_t v )       { color = v; }
+  void SetTexture( const std::string& v ) { texture = v; }
+};
+
+DINJECT_CLASS(Particle) {
+  dinject::Class<Particle>("particle")
+    .AddPrimitive<double>      ("x",&Particle::SetX)
+    .AddPrimitive<double>      ("y",&Particle::SetY)
+    .AddPrimitive<double>      ("life",&Particle::SetLife)
+    .AddPrimitive<std::int32_t>("color",&Particle::SetColor)
+    .AddString                 ("texture",&Particle::SetTexture);
+}
+
+int main() {
+  auto config = dinject::NewDefaultConfigObject();
+  config->Set("x",dinject::Val(1.0));
+  config->Set("y",dinject::Val(2.0));
+  config->Set("life",dinject::Val(3.0));
+  config->Set("color",dinject::Val(0xff00ff));
+  config->Set("texture",dinject::Val("spark.png"));
+
+  const std::size_t kCount = 5000;
+  const std::size_t kIterations = 50;
+
+  // every number is the cost of one instance
+  bench::Run("New<Particle> loop",kIterations*kCount,[&]() {
+    auto p = dinject::New<Particle>("particle",*config);
+    bench::DoNotOptimize(p);
+  });
+
+  double batch = bench::Run("NewBatch<Particle> x5000",kIterations,[&]() {
+    auto v = dinject::NewBatch<Particle>("particle",*config,kCount);
+    bench::DoNotOptimize(v);
+  });
+  std::printf("  per instance: %.2f ns\n",batch/kCount);
+
+  auto buffer = static_cast<Particle*>(
+      std::malloc(sizeof(Particle)*kCount));
+  double inplace = bench::Run("NewBatch<Particle> in place x5000",
+                              kIterations,[&]() {
+    auto n = dinject::NewBatch<Particle>("particle",*config,buffer,kCount);
+    bench::DoNotOptimize(buffer);
+    for( std::size_t i = 0 ; i < n ; ++i ) buffer[i].~Particle();
+  });
+  std::printf("  per instance: %.2f ns\n",inplace/kCount);
+
+  double direct = bench::Run("direct construct x5000",kIterations,[&]() {
+    const std::string texture("spark.png");
+    for( std::size_t i = 0 ; i < kCount ; ++i ) {
+      auto p = new (buffer + i) Particle();
+      p->SetX(1.0);
+      p->SetY(2.0);
+      p->SetLife(3.0);
+      p->SetColor(0xff00ff);
+      p->SetTexture(texture);
+    }
+    bench::DoNotOptimize(buffer);
+    for( std::size_t i = 0 ; i < kCount ; ++i ) buffer[i].~Particle();
+  });
+  std::printf("  per instance: %.2f ns\n",direct/kCount);
+
+  std::free(buffer);
+  return 0;
+}
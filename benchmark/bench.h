@@ -0,0 +1,74 @@
+#ifndef DINJECT_BENCHMARK_BENCH_H_
+#define DINJECT_BENCHMARK_BENCH_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <utility>
+
+namespace bench {
+
+// Prevent the compiler from optimizing away the result of a benchmark
+template< typename T > inline void DoNotOptimize( const T& value ) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// Write a JSON string , the names only need quote and backslash escaped
+inline void WriteJsonString( std::FILE* file , const char* str ) {
+  std::fputc('"',file);
+  for( ; *str ; ++str ) {
+    if(*str == '"' || *str == '\\') std::fputc('\\',file);
+    std::fputc(*str,file);
+  }
+  std::fputc('"',file);
+}
+
+// If DINJECT_BENCH_JSON is set , each result is appended to that file as
+// one JSON object per line , DINJECT_BENCH_SUITE names the benchmark program
+inline void Record( const char* name , std::size_t iterations , double ns ) {
+  auto path = std::getenv("DINJECT_BENCH_JSON");
+  if(!path) return;
+  auto file = std::fopen(path,"a");
+  if(!file) return;
+  auto suite = std::getenv("DINJECT_BENCH_SUITE");
+  std::fputs("{\"suite\":",file);
+  WriteJsonString(file,suite ? suite : "");
+  std::fputs(",\"name\":",file);
+  WriteJsonString(file,name);
+  std::fprintf(file,",\"iterations\":%zu,\"ns_per_op\":%.1f}\n",
+               iterations,ns);
+  std::fclose(file);
+}
+
+// Run the function for given iterations where each call performs ops
+// operations , e.g. builds a batch of objects on several threads. Prints
+// out and records the nanoseconds each operation takes with the number of
+// operations as iterations , returns the nanoseconds per operation
+template< typename F >
+double RunBatch( const char* name , std::size_t iterations , std::size_t ops ,
+                                    F&& func ) {
+  for( std::size_t i = 0 ; i < iterations / 10 + 1 ; ++i ) func(); // warm up
+
+  auto start = std::chrono::steady_clock::now();
+  for( std::size_t i = 0 ; i < iterations ; ++i ) func();
+  auto end   = std::chrono::steady_clock::now();
+
+  auto total = iterations * ops;
+  double ns = std::chrono::duration<double,std::nano>(end-start).count() /
+              static_cast<double>(total);
+  std::printf("%-48s %12zu iterations %12.1f ns/op\n",name,total,ns);
+  Record(name,total,ns);
+  return ns;
+}
+
+// Run the function for given iterations and print out the nanoseconds
+// each iteration takes , returns the nanoseconds per iteration
+template< typename F >
+double Run( const char* name , std::size_t iterations , F&& func ) {
+  return RunBatch(name,iterations,1,std::forward<F>(func));
+}
+
+} // namespace bench
+
+#endif // DINJECT_BENCHMARK_BENCH_H_
@@ -0,0 +1,96 @@
+#include "dinject.h"
+#include "binary.h"
+#include "json.h"
+#include "bench.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct Prop {
+  std::int32_t x;
+  std::int32_t y;
+  double rotation;
+  std::string mesh;
+
+  Prop() : x(), y(), rotation(), mesh() {}
+
+  void SetX       ( std::int32_t v )       { x = v; }
+  void SetY       ( std::int32_t v )       { y = v; }
+  void SetRotation( double v )             { rotation = v; }
+  void SetMesh    ( const std::string& v ) { mesh = v; }
+};
+
+DINJECT_CLASS(Prop) {
+  dinject::Class<Prop>("prop")
+    .AddPrimitive<std::int32_t>("x",&Prop::SetX)
+    .AddPrimitive<std::int32_t>("y",&Prop::SetY)
+    .AddPrimitive<double>      ("rotation",&Prop::SetRotation)
+    .AddString                 ("mesh",&Prop::SetMesh);
+}
+
+static const int kProp = 256;
+static std::string kKeys[kProp];
+
+struct Prefab {
+  std::vector<std::unique_ptr<Prop>> props;
+
+  Prefab() : props() {}
+
+  void AddProp( Prop* p ) { props.emplace_back(p); }
+};
+
+DINJECT_CLASS(Prefab) {
+  auto &klass = dinject::Class<Prefab>("prefab");
+  for( int i = 0 ; i < kProp ; ++i ) {
+    kKeys[i] = "prop" + std::to_string(i);
+    klass.AddObject<Prop>(kKeys[i].c_str(),"prop",&Prefab::AddProp);
+  }
+}
+
+int main() {
+  dinject::Freeze();
+
+  std::string json = "{";
+  auto config = dinject::NewDefaultConfigObject();
+  for( int i = 0 ; i < kProp ; ++i ) {
+    auto prop = dinject::NewDefaultConfigObject();
+    prop->Set("x",dinject::Val(i));
+    prop->Set("y",dinject::Val(i*2));
+    prop->Set("rotation",dinject::Val(0.5));
+    prop->Set("mesh",dinject::Val("rock.mesh"));
+    config->Set(kKeys[i],dinject::Val(prop));
+
+    if(i) json += ",";
+    json += "\"" + kKeys[i] + "\":{\"x\":" + std::to_string(i) + ",\"y\":" +
+            std::to_string(i*2) + ",\"rotation\":0.5,\"mesh\":\"rock.mesh\"}";
+  }
+  json += "}";
+
+  const char* path = "binary-bench.bin";
+  dinject::WriteBinaryConfig(*config,path);
+
+  const std::size_t kIterations = 200;
+  bench::Run("NewFromJson<Prefab> text",kIterations,[&]() {
+    auto p = dinject::NewFromJson<Prefab>("prefab",json);
+    bench::DoNotOptimize(p);
+  });
+  bench::Run("New<Prefab> map config",kIterations,[&]() {
+    auto p = dinject::New<Prefab>("prefab",*config);
+    bench::DoNotOptimize(p);
+  });
+  bench::Run("OpenBinaryConfig",kIterations,[&]() {
+    auto view = dinject::OpenBinaryConfig(path);
+    bench::DoNotOptimize(view);
+  });
+  bench::Run("OpenBinaryConfig + New<Prefab>",kIterations,[&]() {
+    auto view = dinject::OpenBinaryConfig(path);
+    auto p = dinject::New<Prefab>("prefab",*view);
+    bench::DoNotOptimize(p);
+  });
+
+  std::remove(path);
+  return 0;
+}
@@ -0,0 +1,80 @@
+#include "dinject.h"
+#include "container.h"
+#include "bench.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// A heavy dependency , like a texture atlas loaded into memory
+struct TextureCache {
+  std::vector<std::uint8_t> pixels;
+
+  TextureCache() : pixels() {}
+
+  void SetSize( std::int64_t v ) {
+    pixels.resize(static_cast<std::size_t>(v));
+    for( std::size_t i = 0 ; i < pixels.size() ; ++i )
+      pixels[i] = static_cast<std::uint8_t>(i);
+  }
+};
+
+DINJECT_CLASS(TextureCache) {
+  dinject::Class<TextureCache>("texture_cache")
+    .AddPrimitive<std::int64_t>("size",&TextureCache::SetSize);
+}
+
+struct Sprite {
+  std::int64_t frame;
+  std::shared_ptr<TextureCache> cache;
+
+  Sprite() : frame(), cache() {}
+
+  void SetFrame( std::int64_t v )                  { frame = v; }
+  void SetCache( std::shared_ptr<TextureCache> v ) { cache = std::move(v); }
+};
+
+DINJECT_CLASS(Sprite) {
+  dinject::Class<Sprite>("sprite")
+    .AddPrimitive<std::int64_t>("frame",&Sprite::SetFrame)
+    .AddShared<TextureCache>   ("cache","texture_cache",&Sprite::SetCache);
+}
+
+int main() {
+  dinject::Freeze();
+
+  const std::int64_t kCacheSize = 64 * 1024;
+  const std::size_t  kSprite    = 2000;
+
+  auto cache = dinject::NewDefaultConfigObject();
+  cache->Set("size",dinject::Val(kCacheSize));
+
+  // every sprite builds its own copy of the cache
+  auto nested = dinject::NewDefaultConfigObject();
+  nested->Set("frame",dinject::Val(1));
+  nested->Set("cache",dinject::Val(cache));
+
+  // every sprite refers to the same cache
+  auto shared = dinject::NewDefaultConfigObject();
+  shared->Set("frame",dinject::Val(1));
+  shared->Set("cache",dinject::Val("@cache"));
+
+  dinject::Container container;
+  container.Register("cache","texture_cache",cache);
+
+  std::vector<std::unique_ptr<Sprite>> sprites(kSprite);
+
+  bench::Run("New<Sprite> x2000 nested cache",10,[&]() {
+    for( auto &s : sprites ) s = dinject::New<Sprite>("sprite",*nested);
+  });
+  std::printf("  cache memory %zu KB\n",
+              kSprite * static_cast<std::size_t>(kCacheSize) / 1024);
+
+  bench::Run("Container::New<Sprite> x2000 shared cache",10,[&]() {
+    for( auto &s : sprites ) s = container.New<Sprite>("sprite",*shared);
+  });
+  std::printf("  cache memory %zu KB\n",
+              static_cast<std::size_t>(kCacheSize) / 1024);
+  return 0;
+}
@@ -0,0 +1,89 @@
+#include "dinject.h"
+#include "plan.h"
+#include "bench.h"
+
+#include <cstdint>
+
+// Same data registered through setters and through fields
+struct SetterParticle {
+  double x;
+  double y;
+  double vx;
+  double vy;
+  double life;
+  std::int32_t color;
+
+  SetterParticle() : x(), y(), vx(), vy(), life(), color() {}
+
+  void SetX    ( double v )       { x = v; }
+  void SetY    ( double v )       { y = v; }
+  void SetVx   ( double v )       { vx = v; }
+  void SetVy   ( double v )       { vy = v; }
+  void SetLife ( double v )       { life = v; }
+  void SetColor( std::int32_t v ) { color = v; }
+};
+
+DINJECT_CLASS(SetterParticle) {
+  dinject::Class<SetterParticle>("setter_particle")
+    .AddPrimitive<double>      ("x",&SetterParticle::SetX)
+    .AddPrimitive<double>      ("y",&SetterParticle::SetY)
+    .AddPrimitive<double>      ("vx",&SetterParticle::SetVx)
+    .AddPrimitive<double>      ("vy",&SetterParticle::SetVy)
+    .AddPrimitive<double>      ("life",&SetterParticle::SetLife)
+    .AddPrimitive<std::int32_t>("color",&SetterParticle::SetColor);
+}
+
+struct FieldParticle {
+  double x;
+  double y;
+  double vx;
+  double vy;
+  double life;
+  std::int32_t color;
+
+  FieldParticle() : x(), y(), vx(), vy(), life(), color() {}
+};
+
+DINJECT_CLASS(FieldParticle) {
+  dinject::Class<FieldParticle>("field_particle")
+    .AddField<&FieldParticle::x>    ("x")
+    .AddField<&FieldParticle::y>    ("y")
+    .AddField<&FieldParticle::vx>   ("vx")
+    .AddField<&FieldParticle::vy>   ("vy")
+    .AddField<&FieldParticle::life> ("life")
+    .AddField<&FieldParticle::color>("color");
+}
+
+int main() {
+  auto config = dinject::NewDefaultConfigObject();
+  config->Set("x",dinject::Val(1.0));
+  config->Set("y",dinject::Val(2.0));
+  config->Set("vx",dinject::Val(3.0));
+  config->Set("vy",dinject::Val(4.0));
+  config->Set("life",dinject::Val(5.0));
+  config->Set("color",dinject::Val(0xff00ff));
+
+  const std::size_t kIterations = 200000;
+  bench::Run("New<SetterParticle>",kIterations,[&]() {
+    auto p = dinject::New<SetterParticle>("setter_particle",*config);
+    bench::DoNotOptimize(p);
+  });
+  bench::Run("New<FieldParticle>",kIterations,[&]() {
+    auto p = dinject::New<FieldParticle>("field_particle",*config);
+    bench::DoNotOptimize(p);
+  });
+
+  dinject::Plan setter("setter_particle",*config);
+  dinject::Plan field("field_particle",*config);
+  SetterParticle sp;
+  FieldParticle fp;
+  bench::Run("Plan::Apply setter",kIterations * 10,[&]() {
+    setter.Apply(&sp);
+    bench::DoNotOptimize(sp);
+  });
+  bench::Run("Plan::Apply field",kIterations * 10,[&]() {
+    field.Apply(&fp);
+    bench::DoNotOptimize(fp);
+  });
+  return 0;
+}
@@ -0,0 +1,91 @@
+#include "dinject.h"
+#include "flat.h"
+#include "bench.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+// Insert , lookup and full iteration of one config object with N keys ,
+// the default std::map based object against FlatConfigObject
+struct Counter : public dinject::ConfigObject::Visitor {
+  std::size_t count = 0;
+  virtual void Visit( std::string_view , dinject::Symbol ,
+                                         const dinject::ConfigValue& ) {
+    ++count;
+  }
+};
+
+static const char* Name( const char* what , std::size_t size ,
+                         const char* type ) {
+  static char name[64];
+  std::snprintf(name,sizeof(name),"%s %zu keys %s",what,size,type);
+  return name;
+}
+
+static void Report( std::size_t size , double ns ) {
+  std::printf("  %.1f ns/entry\n",ns / static_cast<double>(size));
+}
+
+static void Run( std::size_t size , std::size_t iterations ) {
+  std::vector<std::string> keys;
+  keys.reserve(size);
+  for( std::size_t i = 0 ; i < size ; ++i )
+    keys.push_back("attribute_" + std::to_string(i));
+
+  // insert in random order , lookup in a different random order
+  std::mt19937 rng(7);
+  std::vector<std::string> insert(keys) , lookup(keys);
+  std::shuffle(insert.begin(),insert.end(),rng);
+  std::shuffle(lookup.begin(),lookup.end(),rng);
+
+  std::shared_ptr<dinject::ConfigObject> map;
+  std::shared_ptr<dinject::FlatConfigObject> flat;
+
+  double ns = bench::Run(Name("insert",size,"map"),iterations,[&]() {
+    map = dinject::NewDefaultConfigObject();
+    for( auto &k : insert ) map->Set(k,dinject::Val(1));
+  });
+  Report(size,ns);
+
+  ns = bench::Run(Name("insert",size,"flat"),iterations,[&]() {
+    flat = dinject::NewFlatConfigObject();
+    flat->Reserve(size);
+    for( auto &k : insert ) flat->Append(k,dinject::Val(1));
+    flat->Seal();
+  });
+  Report(size,ns);
+
+  ns = bench::Run(Name("lookup",size,"map"),iterations,[&]() {
+    for( auto &k : lookup ) bench::DoNotOptimize(map->Get(k));
+  });
+  Report(size,ns);
+
+  ns = bench::Run(Name("lookup",size,"flat"),iterations,[&]() {
+    for( auto &k : lookup ) bench::DoNotOptimize(flat->Get(k));
+  });
+  Report(size,ns);
+
+  ns = bench::Run(Name("iterate",size,"map"),iterations,[&]() {
+    Counter c;
+    map->ForEach(&c);
+    bench::DoNotOptimize(c.count);
+  });
+  Report(size,ns);
+
+  ns = bench::Run(Name("iterate",size,"flat"),iterations,[&]() {
+    Counter c;
+    flat->ForEach(&c);
+    bench::DoNotOptimize(c.count);
+  });
+  Report(size,ns);
+}
+
+int main() {
+  Run(1000,1000);
+  Run(100000,10);
+  Run(1000000,1);
+  return 0;
+}
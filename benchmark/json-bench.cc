@@ -0,0 +1,122 @@
+#include "dinject.h"
+#include "json.h"
+#include "bench.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct Tile {
+  std::int32_t x;
+  std::int32_t y;
+  double height;
+  std::string texture;
+
+  Tile() : x(), y(), height(), texture() {}
+
+  void SetX      ( std::int32_t v )       { x = v; }
+  void SetY      ( std::int32_t v )       { y = v; }
+  void SetHeight ( double v )             { height = v; }
+  void SetTexture( const std::string& v ) { texture = v; }
+};
+
+DINJECT_CLASS(Tile) {
+  dinject::Class<Tile>("tile")
+    .AddPrimitive<std::int32_t>("x",&Tile::SetX)
+    .AddPrimitive<std::int32_t>("y",&Tile::SetY)
+    .AddPrimitive<double>      ("height",&Tile::SetHeight)
+    .AddString                 ("texture",&Tile::SetTexture);
+}
+
+static const int kTile = 256;
+static std::string kKeys[kTile];
+
+struct Level {
+  std::vector<std::unique_ptr<Tile>> tiles;
+
+  Level() : tiles() {}
+
+  void AddTile( Tile* t ) { tiles.emplace_back(t); }
+};
+
+DINJECT_CLASS(Level) {
+  auto &klass = dinject::Class<Level>("level");
+  for( int i = 0 ; i < kTile ; ++i ) {
+    kKeys[i] = "tile" + std::to_string(i);
+    klass.AddObject<Tile>(kKeys[i].c_str(),"tile",&Level::AddTile);
+  }
+}
+
+// A minimal JSON to ConfigObject parser , stands for the old path which
+// materializes the whole document before injection
+static std::shared_ptr<dinject::ConfigObject> ParseTree( const char*& p );
+
+static void SkipSpace( const char*& p ) {
+  while(*p == ' ' || *p == '\n') ++p;
+}
+
+static std::string ParseString( const char*& p ) {
+  ++p;
+  auto start = p;
+  while(*p != '"') ++p;
+  return std::string(start,p++);
+}
+
+static dinject::ConfigValue ParseValue( const char*& p ) {
+  SkipSpace(p);
+  if(*p == '{') return dinject::Val(ParseTree(p));
+  if(*p == '"') return dinject::Val(ParseString(p));
+  char* end;
+  auto start = p;
+  auto i = std::strtoll(p,&end,10);
+  if(*end == '.' || *end == 'e') {
+    auto d = std::strtod(start,&end);
+    p = end;
+    return dinject::Val(d);
+  }
+  p = end;
+  return dinject::Val(static_cast<std::int64_t>(i));
+}
+
+static std::shared_ptr<dinject::ConfigObject> ParseTree( const char*& p ) {
+  auto config = dinject::NewDefaultConfigObject();
+  SkipSpace(p);
+  ++p; // {
+  for( ;; ) {
+    SkipSpace(p);
+    if(*p == '}') { ++p; break; }
+    auto key = ParseString(p);
+    SkipSpace(p);
+    ++p; // :
+    config->Set(key,ParseValue(p));
+    SkipSpace(p);
+    if(*p == ',') ++p;
+  }
+  return config;
+}
+
+int main() {
+  std::string json = "{\n";
+  for( int i = 0 ; i < kTile ; ++i ) {
+    if(i) json += ",\n";
+    json += "\"" + kKeys[i] + "\": { \"x\": " + std::to_string(i) +
+            ", \"y\": " + std::to_string(i*2) + ", \"height\": 1.25" +
+            ", \"texture\": \"grass.png\" }";
+  }
+  json += "\n}";
+
+  const std::size_t kIterations = 200;
+  bench::Run("parse tree + New<Level>",kIterations,[&]() {
+    const char* p = json.c_str();
+    auto config = ParseTree(p);
+    auto l = dinject::New<Level>("level",*config);
+    bench::DoNotOptimize(l);
+  });
+  bench::Run("NewFromJson<Level>",kIterations,[&]() {
+    auto l = dinject::NewFromJson<Level>("level",json);
+    bench::DoNotOptimize(l);
+  });
+  return 0;
+}
@@ -0,0 +1,84 @@
+#include "dinject.h"
+#include "json.h"
+#include "bench.h"
+
+#include <cstdint>
+#include <string>
+
+struct Spawn {
+  std::int32_t x;
+  std::int32_t y;
+  std::string kind;
+
+  Spawn() : x(), y(), kind() {}
+
+  void SetX   ( std::int32_t v )       { x = v; }
+  void SetY   ( std::int32_t v )       { y = v; }
+  void SetKind( const std::string& v ) { kind = v; }
+};
+
+DINJECT_CLASS(Spawn) {
+  dinject::Class<Spawn>("spawn")
+    .AddPrimitive<std::int32_t>("x",&Spawn::SetX)
+    .AddPrimitive<std::int32_t>("y",&Spawn::SetY)
+    .AddString                 ("kind",&Spawn::SetKind);
+}
+
+struct Level {
+  std::string name;
+  Spawn spawn;
+
+  Level() : name(), spawn() {}
+
+  void SetName( const std::string& v ) { name = v; }
+  Spawn* GetSpawn()                    { return &spawn; }
+};
+
+DINJECT_CLASS(Level) {
+  dinject::Class<Level>("level")
+    .AddString       ("name",&Level::SetName)
+    .AddStruct<Spawn>("spawn","spawn",&Level::GetSpawn);
+}
+
+// Visit every value , which forces the lazy object to parse everything like
+// a parser which builds the whole tree
+class Touch : public dinject::ConfigObject::Visitor {
+ public:
+  virtual void Visit( std::string_view , dinject::Symbol ,
+                      const dinject::ConfigValue& value ) {
+    auto obj = std::get_if<std::shared_ptr<dinject::ConfigObject>>(&value);
+    if(obj) (*obj)->ForEach(this);
+  }
+};
+
+int main() {
+  // the level only uses a tiny part of the document , the editor section is
+  // large and is not known by the class
+  std::string json = "{\"name\":\"forest\",\"spawn\":{\"x\":1,\"y\":2,"
+                     "\"kind\":\"player\"},\"editor\":{";
+  for( int i = 0 ; i < 5000 ; ++i ) {
+    if(i) json += ",";
+    json += "\"node" + std::to_string(i) + "\":{\"pos\":[1,2,3],"
+            "\"comment\":\"placed by hand\",\"weight\":0.5}";
+  }
+  json += "}}";
+
+  const std::size_t kIterations = 50;
+  bench::Run("lazy + parse everything + New<Level>",kIterations,[&]() {
+    auto config = dinject::NewLazyJsonConfigObject(json);
+    Touch touch;
+    config->ForEach(&touch);
+    auto l = dinject::New<Level>("level",*config);
+    bench::DoNotOptimize(l);
+  });
+  bench::Run("lazy + New<Level>",kIterations,[&]() {
+    auto config = dinject::NewLazyJsonConfigObject(json);
+    auto l = dinject::New<Level>("level",*config);
+    bench::DoNotOptimize(l);
+  });
+  bench::Run("NewFromJson<Level>",kIterations,[&]() {
+    auto l = dinject::NewFromJson<Level>("level",json);
+    bench::DoNotOptimize(l);
+  });
+  return 0;
+}
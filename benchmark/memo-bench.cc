@@ -0,0 +1,96 @@
+#include "dinject.h"
+#include "memo.h"
+#include "bench.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// A material block which is repeated in lots of meshes , the setter of
+// texture does some work like decoding a small lookup table
+struct Material {
+  std::string texture;
+  std::vector<float> table;
+  double roughness;
+  double metallic;
+  std::int64_t layer;
+
+  Material() : texture(), table(), roughness(), metallic(), layer() {}
+
+  void SetTexture( const std::string& v ) {
+    texture = v;
+    table.resize(256);
+    for( std::size_t i = 0 ; i < table.size() ; ++i )
+      table[i] = static_cast<float>(i * v.size());
+  }
+  void SetRoughness( double v )      { roughness = v; }
+  void SetMetallic ( double v )      { metallic = v; }
+  void SetLayer    ( std::int64_t v ) { layer = v; }
+};
+
+DINJECT_CLASS(Material) {
+  dinject::Class<Material>("material")
+    .AddString                 ("texture",&Material::SetTexture)
+    .AddPrimitive<double>      ("roughness",&Material::SetRoughness)
+    .AddPrimitive<double>      ("metallic",&Material::SetMetallic)
+    .AddPrimitive<std::int64_t>("layer",&Material::SetLayer)
+    .Memoize();
+}
+
+struct Mesh {
+  std::unique_ptr<Material> material;
+  std::int64_t lod;
+
+  Mesh() : material(), lod() {}
+
+  void SetMaterial( Material* v )    { material.reset(v); }
+  void SetLod     ( std::int64_t v ) { lod = v; }
+};
+
+DINJECT_CLASS(Mesh) {
+  dinject::Class<Mesh>("mesh")
+    .AddObject<Material>       ("material","material",&Mesh::SetMaterial)
+    .AddPrimitive<std::int64_t>("lod",&Mesh::SetLod);
+}
+
+int main() {
+  dinject::Freeze();
+
+  // 2000 meshes sharing 4 distinct material blocks
+  const int kMesh = 2000;
+  std::vector<std::shared_ptr<dinject::ConfigObject>> meshes;
+  for( int i = 0 ; i < kMesh ; ++i ) {
+    auto material = dinject::NewDefaultConfigObject();
+    material->Set("texture",dinject::Val("textures/stone_" +
+                                         std::to_string(i % 4) + ".png"));
+    material->Set("roughness",dinject::Val(0.5));
+    material->Set("metallic",dinject::Val(0.1));
+    material->Set("layer",dinject::Val(3));
+
+    auto mesh = dinject::NewDefaultConfigObject();
+    mesh->Set("material",dinject::Val(material));
+    mesh->Set("lod",dinject::Val(i));
+    meshes.push_back(mesh);
+  }
+
+  bench::Run("New<Mesh> x2000",20,[&]() {
+    for( auto &m : meshes ) {
+      auto mesh = dinject::New<Mesh>("mesh",*m);
+      bench::DoNotOptimize(mesh);
+    }
+  });
+
+  dinject::MemoCache memo(1024 * 1024);
+  bench::Run("New<Mesh> x2000 MemoCache",20,[&]() {
+    for( auto &m : meshes ) {
+      auto mesh = dinject::New<Mesh>("mesh",*m,memo);
+      bench::DoNotOptimize(mesh);
+    }
+  });
+
+  auto stats = memo.stats();
+  std::printf("  hit %zu miss %zu evict %zu cached %zu bytes %zu\n",
+              stats.hit,stats.miss,stats.evict,stats.count,stats.bytes);
+  return 0;
+}
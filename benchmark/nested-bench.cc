@@ -0,0 +1,73 @@
+#include "dinject.h"
+#include "bench.h"
+
+#include <cstdint>
+#include <string>
+
+// Level<N> embeds Level<N-1> as a struct attribute , used to build deeply
+// nested struct configs
+template< int N > struct Level {
+  std::int64_t value;
+  Level<N-1> child;
+
+  Level() : value(), child() {}
+
+  void SetValue( std::int64_t v ) { value = v; }
+  Level<N-1>* GetChild() { return &child; }
+};
+
+template<> struct Level<0> {
+  std::int64_t value;
+
+  Level() : value() {}
+
+  void SetValue( std::int64_t v ) { value = v; }
+};
+
+static const int kDepth = 8;
+
+static std::string kLevelNames[kDepth+1];
+
+template< int N > struct Register {
+  static void Do() {
+    Register<N-1>::Do();
+    dinject::Class<Level<N>>(kLevelNames[N].c_str())
+      .template AddPrimitive<std::int64_t>("value",&Level<N>::SetValue)
+      .template AddStruct<Level<N-1>>("child",kLevelNames[N-1].c_str(),
+                                      &Level<N>::GetChild);
+  }
+};
+
+template<> struct Register<0> {
+  static void Do() {
+    dinject::Class<Level<0>>(kLevelNames[0].c_str())
+      .AddPrimitive<std::int64_t>("value",&Level<0>::SetValue);
+  }
+};
+
+static std::shared_ptr<dinject::ConfigObject> NewConfig( int depth ) {
+  auto config = dinject::NewDefaultConfigObject();
+  config->Set("value",dinject::Val(depth));
+  if(depth > 0) config->Set("child",dinject::Val(NewConfig(depth-1)));
+  return config;
+}
+
+int main() {
+  for( int i = 0 ; i <= kDepth ; ++i )
+    kLevelNames[i] = "level" + std::to_string(i);
+  Register<kDepth>::Do();
+
+  auto config = NewConfig(kDepth);
+
+  bench::Run("New<Level<8>> nested struct depth 8",200000,[&]() {
+    auto v = dinject::New<Level<kDepth>>(kLevelNames[kDepth].c_str(),*config);
+    bench::DoNotOptimize(v);
+  });
+
+  auto shallow = NewConfig(1);
+  bench::Run("New<Level<1>> nested struct depth 1",200000,[&]() {
+    auto v = dinject::New<Level<1>>(kLevelNames[1].c_str(),*shallow);
+    bench::DoNotOptimize(v);
+  });
+  return 0;
+}
@@ -0,0 +1,85 @@
+#include "dinject.h"
+#include "executor.h"
+#include "bench.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+// A terrain chunk whose setter does real work , like generating a mesh
+struct Chunk {
+  std::int64_t seed;
+  std::vector<float> heights;
+
+  Chunk() : seed(), heights() {}
+
+  void SetSeed( std::int64_t v ) {
+    seed = v;
+    heights.resize(16384);
+    std::uint64_t h = static_cast<std::uint64_t>(v);
+    for( auto &e : heights ) {
+      h = h * 6364136223846793005ull + 1442695040888963407ull;
+      e = static_cast<float>(h >> 40);
+    }
+  }
+};
+
+DINJECT_CLASS(Chunk) {
+  dinject::Class<Chunk>("chunk")
+    .AddPrimitive<std::int64_t>("seed",&Chunk::SetSeed);
+}
+
+static const int kChunk = 256;
+static std::string kKeys[kChunk];
+
+struct Terrain {
+  std::vector<std::unique_ptr<Chunk>> chunks;
+
+  Terrain() : chunks() {}
+
+  void AddChunk( Chunk* c ) { chunks.emplace_back(c); }
+};
+
+DINJECT_CLASS(Terrain) {
+  auto &klass = dinject::Class<Terrain>("terrain");
+  for( int i = 0 ; i < kChunk ; ++i ) {
+    kKeys[i] = "chunk" + std::to_string(i);
+    klass.AddObject<Chunk>(kKeys[i].c_str(),"chunk",&Terrain::AddChunk);
+  }
+}
+
+int main() {
+  dinject::Freeze();
+
+  auto terrain = dinject::NewDefaultConfigObject();
+  for( int i = 0 ; i < kChunk ; ++i ) {
+    auto chunk = dinject::NewDefaultConfigObject();
+    chunk->Set("seed",dinject::Val(i));
+    terrain->Set(kKeys[i],dinject::Val(chunk));
+  }
+
+  const std::size_t kIterations = 20;
+  double serial = bench::Run("New<Terrain> serial",kIterations,[&]() {
+    auto t = dinject::New<Terrain>("terrain",*terrain);
+    bench::DoNotOptimize(t);
+  });
+
+  std::size_t max_core = std::thread::hardware_concurrency();
+  if(max_core < 1) max_core = 1;
+
+  // the calling thread also runs tasks , so N cores means N-1 workers
+  for( std::size_t core = 1 ; core <= max_core ; core *= 2 ) {
+    dinject::ThreadPool pool(core-1);
+    char name[64];
+    std::snprintf(name,sizeof(name),"NewParallel<Terrain> %zu cores",core);
+    double ns = bench::Run(name,kIterations,[&]() {
+      auto t = dinject::NewParallel<Terrain>("terrain",*terrain,pool);
+      bench::DoNotOptimize(t);
+    });
+    std::printf("  scaling %zu cores: %.2fx\n",core,serial/ns);
+  }
+  return 0;
+}
@@ -0,0 +1,111 @@
+#include "dinject.h"
+#include "plan.h"
+#include "bench.h"
+
+#include <cstdint>
+#include <cstdio>
+
+struct Stats {
+  std::int32_t hp;
+  std::int32_t mp;
+  double speed;
+
+  Stats() : hp(), mp(), speed() {}
+
+  void SetHp   ( std::int32_t v ) { hp = v; }
+  void SetMp   ( std::int32_t v ) { mp = v; }
+  void SetSpeed( double v )       { speed = v; }
+};
+
+DINJECT_CLASS(Stats) {
+  dinject::Class<Stats>("stats")
+    .AddPrimitive<std::int32_t>("hp",&Stats::SetHp)
+    .AddPrimitive<std::int32_t>("mp",&Stats::SetMp)
+    .AddPrimitive<double>      ("speed",&Stats::SetSpeed);
+}
+
+struct Bullet {
+  std::int32_t damage;
+  double velocity;
+  bool piercing;
+  std::string sprite;
+
+  Bullet() : damage(), velocity(), piercing(), sprite() {}
+
+  void SetDamage  ( std::int32_t v )       { damage = v; }
+  void SetVelocity( double v )             { velocity = v; }
+  void SetPiercing( bool v )               { piercing = v; }
+  void SetSprite  ( const std::string& v ) { sprite = v; }
+};
+
+DINJECT_CLASS(Bullet) {
+  dinject::Class<Bullet>("bullet")
+    .AddPrimitive<std::int32_t>("damage",&Bullet::SetDamage)
+    .AddPrimitive<double>      ("velocity",&Bullet::SetVelocity)
+    .AddPrimitive<bool>        ("piercing",&Bullet::SetPiercing)
+    .AddString                 ("sprite",&Bullet::SetSprite);
+}
+
+struct Unit {
+  std::string name;
+  Stats stats;
+  std::unique_ptr<Bullet> bullet;
+
+  Unit() : name(), stats(), bullet() {}
+
+  void SetName  ( const std::string& v ) { name = v; }
+  void SetBullet( Bullet* v )            { bullet.reset(v); }
+  Stats* GetStats()                      { return &stats; }
+};
+
+DINJECT_CLASS(Unit) {
+  dinject::Class<Unit>("unit")
+    .AddString           ("name",&Unit::SetName)
+    .AddStruct<Stats>    ("stats","stats",&Unit::GetStats)
+    .AddObject<Bullet>   ("bullet","bullet",&Unit::SetBullet);
+}
+
+int main() {
+  const std::size_t kIterations = 200000;
+
+  auto bullet = dinject::NewDefaultConfigObject();
+  bullet->Set("damage",dinject::Val(10));
+  bullet->Set("velocity",dinject::Val(300.0));
+  bullet->Set("piercing",dinject::Val(false));
+  bullet->Set("sprite",dinject::Val("bullet.png"));
+
+  auto stats = dinject::NewDefaultConfigObject();
+  stats->Set("hp",dinject::Val(100));
+  stats->Set("mp",dinject::Val(50));
+  stats->Set("speed",dinject::Val(4.5));
+
+  auto unit = dinject::NewDefaultConfigObject();
+  unit->Set("name",dinject::Val("archer"));
+  unit->Set("stats",dinject::Val(stats));
+  unit->Set("bullet",dinject::Val(bullet));
+
+  double n0 = bench::Run("New<Bullet> flat",kIterations,[&]() {
+    auto v = dinject::New<Bullet>("bullet",*bullet);
+    bench::DoNotOptimize(v);
+  });
+
+  dinject::Plan bullet_plan("bullet",*bullet);
+  double p0 = bench::Run("Plan::New<Bullet> flat",kIterations,[&]() {
+    auto v = bullet_plan.New<Bullet>();
+    bench::DoNotOptimize(v);
+  });
+
+  double n1 = bench::Run("New<Unit> nested",kIterations,[&]() {
+    auto v = dinject::New<Unit>("unit",*unit);
+    bench::DoNotOptimize(v);
+  });
+
+  dinject::Plan unit_plan("unit",*unit);
+  double p1 = bench::Run("Plan::New<Unit> nested",kIterations,[&]() {
+    auto v = unit_plan.New<Unit>();
+    bench::DoNotOptimize(v);
+  });
+
+  std::printf("speedup flat %.2fx , nested %.2fx\n",n0/p0,n1/p1);
+  return 0;
+}
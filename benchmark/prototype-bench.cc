@@ -0,0 +1,70 @@
+#include "dinject.h"
+#include "plan.h"
+#include "prototype.h"
+#include "bench.h"
+
+#include <cstdint>
+#include <string>
+
+struct Bullet {
+  std::int32_t damage;
+  double velocity;
+  double spread;
+  double lifetime;
+  bool piercing;
+  std::string sprite;
+
+  Bullet() : damage(), velocity(), spread(), lifetime(), piercing(), sprite() {}
+
+  void SetDamage  ( std::int32_t v )       { damage = v; }
+  void SetVelocity( double v )             { velocity = v; }
+  void SetSpread  ( double v )             { spread = v; }
+  void SetLifetime( double v )             { lifetime = v; }
+  void SetPiercing( bool v )               { piercing = v; }
+  void SetSprite  ( const std::string& v ) { sprite = v; }
+};
+
+DINJECT_CLASS(Bullet) {
+  dinject::Class<Bullet>("bullet")
+    .AddPrimitive<std::int32_t>("damage",&Bullet::SetDamage)
+    .AddPrimitive<double>      ("velocity",&Bullet::SetVelocity)
+    .AddPrimitive<double>      ("spread",&Bullet::SetSpread)
+    .AddPrimitive<double>      ("lifetime",&Bullet::SetLifetime)
+    .AddPrimitive<bool>        ("piercing",&Bullet::SetPiercing)
+    .AddString                 ("sprite",&Bullet::SetSprite);
+}
+
+int main() {
+  auto config = dinject::NewDefaultConfigObject();
+  config->Set("damage",dinject::Val(10));
+  config->Set("velocity",dinject::Val(300.0));
+  config->Set("spread",dinject::Val(0.1));
+  config->Set("lifetime",dinject::Val(2.0));
+  config->Set("piercing",dinject::Val(true));
+  config->Set("sprite",dinject::Val("bullet.png"));
+
+  dinject::RegisterPrototype<Bullet>("bullet","bullet",*config);
+  dinject::Plan plan("bullet",*config);
+
+  auto overrides = dinject::NewDefaultConfigObject();
+  overrides->Set("damage",dinject::Val(20));
+
+  const std::size_t kIterations = 200000;
+  bench::Run("New<Bullet>",kIterations,[&]() {
+    auto b = dinject::New<Bullet>("bullet",*config);
+    bench::DoNotOptimize(b);
+  });
+  bench::Run("Plan::New<Bullet>",kIterations,[&]() {
+    auto b = plan.New<Bullet>();
+    bench::DoNotOptimize(b);
+  });
+  bench::Run("Clone<Bullet>",kIterations,[&]() {
+    auto b = dinject::Clone<Bullet>("bullet");
+    bench::DoNotOptimize(b);
+  });
+  bench::Run("Clone<Bullet> with override",kIterations,[&]() {
+    auto b = dinject::Clone<Bullet>("bullet",*overrides);
+    bench::DoNotOptimize(b);
+  });
+  return 0;
+}
@@ -0,0 +1,85 @@
+#include "dinject.h"
+#include "reload.h"
+#include "bench.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A world of zones , each zone setter does some real work
+struct Zone {
+  std::int64_t seed;
+  std::vector<float> heights;
+
+  Zone() : seed(), heights() {}
+
+  void SetSeed( std::int64_t v ) {
+    seed = v;
+    heights.resize(4096);
+    std::uint64_t h = static_cast<std::uint64_t>(v);
+    for( auto &e : heights ) {
+      h = h * 6364136223846793005ull + 1442695040888963407ull;
+      e = static_cast<float>(h >> 40);
+    }
+  }
+};
+
+DINJECT_CLASS(Zone) {
+  dinject::Class<Zone>("zone")
+    .AddPrimitive<std::int64_t>("seed",&Zone::SetSeed);
+}
+
+static const int kZone = 256;
+static std::string kKeys[kZone];
+
+struct World {
+  std::vector<std::unique_ptr<Zone>> zones;
+
+  World() : zones(kZone) {}
+
+  template< int I > void SetZone( Zone* z ) { zones[I].reset(z); }
+};
+
+template< int I > struct RegisterZone {
+  static void Run( dinject::detail::KlassImpl<World>& klass ) {
+    kKeys[I] = "zone" + std::to_string(I);
+    klass.AddObject<Zone>(kKeys[I].c_str(),"zone",&World::SetZone<I>);
+    RegisterZone<I+1>::Run(klass);
+  }
+};
+
+template<> struct RegisterZone<kZone> {
+  static void Run( dinject::detail::KlassImpl<World>& ) {}
+};
+
+DINJECT_CLASS(World) {
+  RegisterZone<0>::Run(dinject::Class<World>("world"));
+}
+
+static std::shared_ptr<dinject::ConfigObject> NewWorld( int edited ) {
+  auto world = dinject::NewDefaultConfigObject();
+  for( int i = 0 ; i < kZone ; ++i ) {
+    auto zone = dinject::NewDefaultConfigObject();
+    zone->Set("seed",dinject::Val(i == edited ? -i : i));
+    world->Set(kKeys[i],dinject::Val(zone));
+  }
+  return world;
+}
+
+int main() {
+  dinject::Freeze();
+
+  auto old_config = NewWorld(-1);
+  auto new_config = NewWorld(7);     // a designer edits one zone
+  auto world = dinject::New<World>("world",*old_config);
+
+  bench::Run("New<World> full rebuild",20,[&]() {
+    auto w = dinject::New<World>("world",*new_config);
+    bench::DoNotOptimize(w);
+  });
+
+  bench::Run("Apply<World> one zone edited",20,[&]() {
+    dinject::Apply(world.get(),"world",*old_config,*new_config);
+  });
+  return 0;
+}
@@ -0,0 +1,86 @@
+#include "dinject.h"
+#include "result.h"
+#include "bench.h"
+
+#include <cstdint>
+#include <string>
+
+struct Sensor {
+  std::int64_t id;
+  double low , high;
+  bool enabled;
+  std::string unit;
+
+  Sensor() : id(), low(), high(), enabled(), unit() {}
+
+  void SetId     ( std::int64_t v )       { id = v; }
+  void SetLow    ( double v )             { low = v; }
+  void SetHigh   ( double v )             { high = v; }
+  void SetEnabled( bool v )               { enabled = v; }
+  void SetUnit   ( const std::string& v ) { unit = v; }
+};
+
+DINJECT_CLASS(Sensor) {
+  dinject::Class<Sensor>("sensor")
+    .AddPrimitive<std::int64_t>("id",&Sensor::SetId)
+    .AddPrimitive<double>      ("low",&Sensor::SetLow)
+    .AddPrimitive<double>      ("high",&Sensor::SetHigh)
+    .AddPrimitive<bool>        ("enabled",&Sensor::SetEnabled)
+    .AddString                 ("unit",&Sensor::SetUnit);
+}
+
+struct Station {
+  std::unique_ptr<Sensor> inside , outside;
+
+  Station() : inside(), outside() {}
+
+  void SetInside ( Sensor* v ) { inside.reset(v); }
+  void SetOutside( Sensor* v ) { outside.reset(v); }
+};
+
+DINJECT_CLASS(Station) {
+  dinject::Class<Station>("station")
+    .AddObject<Sensor>("inside","sensor",&Station::SetInside)
+    .AddObject<Sensor>("outside","sensor",&Station::SetOutside);
+}
+
+static std::shared_ptr<dinject::ConfigObject> NewSensor() {
+  auto sensor = dinject::NewDefaultConfigObject();
+  sensor->Set("id",dinject::Val(1));
+  sensor->Set("low",dinject::Val(-20.0));
+  sensor->Set("high",dinject::Val(50.0));
+  sensor->Set("enabled",dinject::Val(true));
+  sensor->Set("unit",dinject::Val("celsius"));
+  return sensor;
+}
+
+int main() {
+  dinject::Freeze();
+
+  auto good = dinject::NewDefaultConfigObject();
+  good->Set("inside",dinject::Val(NewSensor()));
+  good->Set("outside",dinject::Val(NewSensor()));
+
+  // a user typed the unit of the last sensor as a number
+  auto bad_sensor = NewSensor();
+  bad_sensor->Set("unit",dinject::Val(1));
+  auto bad = dinject::NewDefaultConfigObject();
+  bad->Set("inside",dinject::Val(NewSensor()));
+  bad->Set("outside",dinject::Val(bad_sensor));
+
+  bench::Run("New<Station> valid config",200000,[&]() {
+    auto o = dinject::New<Station>("station",*good);
+    bench::DoNotOptimize(o);
+  });
+
+  bench::Run("TryNew<Station> valid config",200000,[&]() {
+    auto o = dinject::TryNew<Station>("station",*good);
+    bench::DoNotOptimize(o.get());
+  });
+
+  bench::Run("TryNew<Station> invalid config",200000,[&]() {
+    auto o = dinject::TryNew<Station>("station",*bad);
+    bench::DoNotOptimize(o.get());
+  });
+  return 0;
+}
@@ -0,0 +1,66 @@
+#include "dinject.h"
+#include "static.h"
+#include "bench.h"
+
+#include <cstdint>
+#include <string>
+
+struct Enemy {
+  std::int32_t hp;
+  std::int32_t mp;
+  double speed;
+  double range;
+  bool flying;
+  std::string model;
+
+  Enemy() : hp(), mp(), speed(), range(), flying(), model() {}
+
+  void SetHp    ( std::int32_t v )       { hp = v; }
+  void SetMp    ( std::int32_t v )       { mp = v; }
+  void SetSpeed ( double v )             { speed = v; }
+  void SetRange ( double v )             { range = v; }
+  void SetFlying( bool v )               { flying = v; }
+  void SetModel ( const std::string& v ) { model = v; }
+};
+
+// The same class described at runtime and at compile time
+DINJECT_CLASS(Enemy) {
+  dinject::Class<Enemy>("enemy")
+    .AddPrimitive<std::int32_t>("hp",&Enemy::SetHp)
+    .AddPrimitive<std::int32_t>("mp",&Enemy::SetMp)
+    .AddPrimitive<double>      ("speed",&Enemy::SetSpeed)
+    .AddPrimitive<double>      ("range",&Enemy::SetRange)
+    .AddPrimitive<bool>        ("flying",&Enemy::SetFlying)
+    .AddString                 ("model",&Enemy::SetModel);
+}
+
+DINJECT_STATIC_CLASS(Enemy) {
+  static constexpr auto attributes = std::make_tuple(
+    dinject::Attr("hp"    ,&Enemy::SetHp),
+    dinject::Attr("mp"    ,&Enemy::SetMp),
+    dinject::Attr("speed" ,&Enemy::SetSpeed),
+    dinject::Attr("range" ,&Enemy::SetRange),
+    dinject::Attr("flying",&Enemy::SetFlying),
+    dinject::Attr("model" ,&Enemy::SetModel));
+};
+
+int main() {
+  auto config = dinject::NewDefaultConfigObject();
+  config->Set("hp",dinject::Val(100));
+  config->Set("mp",dinject::Val(50));
+  config->Set("speed",dinject::Val(1.5));
+  config->Set("range",dinject::Val(8.0));
+  config->Set("flying",dinject::Val(false));
+  config->Set("model",dinject::Val("goblin.mesh"));
+
+  const std::size_t kIterations = 200000;
+  bench::Run("New<Enemy> registry",kIterations,[&]() {
+    auto e = dinject::New<Enemy>("enemy",*config);
+    bench::DoNotOptimize(e);
+  });
+  bench::Run("New<Enemy> static",kIterations,[&]() {
+    auto e = dinject::New<Enemy>(*config);
+    bench::DoNotOptimize(e);
+  });
+  return 0;
+}
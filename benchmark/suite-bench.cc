@@ -0,0 +1,222 @@
+#include "dinject.h"
+#include "bench.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Core operations of the library in one place , run with make bench-json to
+// track them between releases
+
+struct Flat {
+  std::int64_t a , b , c , d;
+  double e , f;
+  bool g;
+  std::string h;
+
+  Flat() : a(), b(), c(), d(), e(), f(), g(), h() {}
+
+  void SetA( std::int64_t v )       { a = v; }
+  void SetB( std::int64_t v )       { b = v; }
+  void SetC( std::int64_t v )       { c = v; }
+  void SetD( std::int64_t v )       { d = v; }
+  void SetE( double v )             { e = v; }
+  void SetF( double v )             { f = v; }
+  void SetG( bool v )               { g = v; }
+  void SetH( const std::string& v ) { h = v; }
+};
+
+static void RegisterFlat( const char* name ) {
+  dinject::Class<Flat>(name)
+    .AddPrimitive<std::int64_t>("a",&Flat::SetA)
+    .AddPrimitive<std::int64_t>("b",&Flat::SetB)
+    .AddPrimitive<std::int64_t>("c",&Flat::SetC)
+    .AddPrimitive<std::int64_t>("d",&Flat::SetD)
+    .AddPrimitive<double>      ("e",&Flat::SetE)
+    .AddPrimitive<double>      ("f",&Flat::SetF)
+    .AddPrimitive<bool>        ("g",&Flat::SetG)
+    .AddString                 ("h",&Flat::SetH);
+}
+
+DINJECT_CLASS(Flat) {
+  RegisterFlat("flat");
+}
+
+struct WithStruct {
+  std::int64_t id;
+  Flat body;
+
+  WithStruct() : id(), body() {}
+
+  void SetId( std::int64_t v ) { id = v; }
+  Flat* GetBody()              { return &body; }
+};
+
+DINJECT_CLASS(WithStruct) {
+  dinject::Class<WithStruct>("with_struct")
+    .AddPrimitive<std::int64_t>("id",&WithStruct::SetId)
+    .AddStruct<Flat>           ("body","flat",&WithStruct::GetBody);
+}
+
+struct WithObject {
+  std::int64_t id;
+  std::unique_ptr<Flat> body;
+
+  WithObject() : id(), body() {}
+
+  void SetId  ( std::int64_t v ) { id = v; }
+  void SetBody( Flat* v )        { body.reset(v); }
+};
+
+DINJECT_CLASS(WithObject) {
+  dinject::Class<WithObject>("with_object")
+    .AddPrimitive<std::int64_t>("id",&WithObject::SetId)
+    .AddObject<Flat>           ("body","flat",&WithObject::SetBody);
+}
+
+// A chain of classes , node8 inherits node7 ... inherits node0
+static const int kDepth = 8;
+
+template< int I > struct Node {
+  void Set( std::int64_t ) {}
+};
+
+static std::string kNodeNames[kDepth+1];
+static std::string kNodeAttrs[kDepth+1];
+
+template< int I > struct RegisterNode {
+  static void Run() {
+    RegisterNode<I-1>::Run();
+    kNodeNames[I] = "node" + std::to_string(I);
+    kNodeAttrs[I] = "attr" + std::to_string(I);
+    dinject::Class<Node<I>>(kNodeNames[I].c_str())
+      .template AddPrimitive<std::int64_t>(kNodeAttrs[I].c_str(),
+                                           &Node<I>::Set)
+      .Inherit(kNodeNames[I-1].c_str());
+  }
+};
+
+template<> struct RegisterNode<0> {
+  static void Run() {
+    kNodeNames[0] = "node0";
+    kNodeAttrs[0] = "attr0";
+    dinject::Class<Node<0>>("node0")
+      .AddPrimitive<std::int64_t>("attr0",&Node<0>::Set);
+  }
+};
+
+DINJECT_CLASS(Node) {
+  RegisterNode<kDepth>::Run();
+}
+
+static std::shared_ptr<dinject::ConfigObject> NewFlatConfig() {
+  auto config = dinject::NewDefaultConfigObject();
+  config->Set("a",dinject::Val(1));
+  config->Set("b",dinject::Val(2));
+  config->Set("c",dinject::Val(3));
+  config->Set("d",dinject::Val(4));
+  config->Set("e",dinject::Val(5.0));
+  config->Set("f",dinject::Val(6.0));
+  config->Set("g",dinject::Val(true));
+  config->Set("h",dinject::Val("flat"));
+  return config;
+}
+
+struct Counter : public dinject::ConfigObject::Visitor {
+  std::size_t count = 0;
+  virtual void Visit( std::string_view , dinject::Symbol ,
+                                         const dinject::ConfigValue& ) {
+    ++count;
+  }
+};
+
+int main() {
+  // registration has to happen before the registry is frozen
+  bench::Run("Class<T> register 8 attributes",10000,[&]() {
+    RegisterFlat("flat_registered");
+  });
+
+  dinject::Freeze();
+
+  bench::Run("GetKlass by name",1000000,[&]() {
+    bench::DoNotOptimize(dinject::detail::GetKlass("with_object"));
+  });
+
+  auto symbol = dinject::FindSymbol("with_object");
+  bench::Run("GetKlass by symbol",1000000,[&]() {
+    bench::DoNotOptimize(dinject::detail::GetKlass(symbol));
+  });
+
+  auto leaf = dinject::detail::GetKlass(kNodeNames[kDepth].c_str());
+  bench::Run("FindAttribute inheritance depth 8",1000000,[&]() {
+    bench::DoNotOptimize(leaf->ResolveAttribute("attr0"));
+  });
+
+  auto flat = NewFlatConfig();
+  bench::Run("New<Flat> 8 attributes",200000,[&]() {
+    auto o = dinject::New<Flat>("flat",*flat);
+    bench::DoNotOptimize(o);
+  });
+
+  auto with_struct = dinject::NewDefaultConfigObject();
+  with_struct->Set("id",dinject::Val(1));
+  with_struct->Set("body",dinject::Val(flat));
+  bench::Run("New<WithStruct> nested struct",200000,[&]() {
+    auto o = dinject::New<WithStruct>("with_struct",*with_struct);
+    bench::DoNotOptimize(o);
+  });
+
+  auto with_object = dinject::NewDefaultConfigObject();
+  with_object->Set("id",dinject::Val(1));
+  with_object->Set("body",dinject::Val(flat));
+  bench::Run("New<WithObject> nested object",200000,[&]() {
+    auto o = dinject::New<WithObject>("with_object",*with_object);
+    bench::DoNotOptimize(o);
+  });
+
+  bench::Run("NewDefaultConfigObject build 8 entries",200000,[&]() {
+    bench::DoNotOptimize(NewFlatConfig());
+  });
+
+  bench::Run("NewDefaultConfigObject ForEach 8 entries",1000000,[&]() {
+    Counter c;
+    flat->ForEach(&c);
+    bench::DoNotOptimize(c.count);
+  });
+
+  bench::Run("NewDefaultConfigObject NewIterator 8 entries",200000,[&]() {
+    std::size_t count = 0;
+    for( auto itr(flat->NewIterator()) ; itr->HasNext() ; itr->Next() ) {
+      std::string key;
+      dinject::ConfigValue val;
+      itr->Get(&key,&val);
+      ++count;
+    }
+    bench::DoNotOptimize(count);
+  });
+
+  // every thread spawns its own objects from the shared config
+  const std::size_t kPerThread = 10000;
+  std::size_t max_thread = std::thread::hardware_concurrency();
+  if(max_thread < 1) max_thread = 1;
+  for( std::size_t thread = 1 ; thread <= max_thread * 2 ; thread *= 2 ) {
+    char name[64];
+    std::snprintf(name,sizeof(name),"New<Flat> %zu threads x%zu",
+                  thread,kPerThread);
+    bench::RunBatch(name,10,thread * kPerThread,[&]() {
+      std::vector<std::thread> threads;
+      for( std::size_t t = 0 ; t < thread ; ++t ) {
+        threads.emplace_back([&]() {
+          for( std::size_t i = 0 ; i < kPerThread ; ++i ) {
+            auto o = dinject::New<Flat>("flat",*flat);
+            bench::DoNotOptimize(o);
+          }
+        });
+      }
+      for( auto &t : threads ) t.join();
+    });
+  }
+  return 0;
+}
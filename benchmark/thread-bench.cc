@@ -0,0 +1,96 @@
+#include "dinject.h"
+#include "bench.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct Particle {
+  double x;
+  double y;
+  double life;
+  std::int32_t color;
+
+  Particle() : x(), y(), life(), color() {}
+
+  void SetX    ( double v )       { x = v; }
+  void SetY    ( double v )       { y = v; }
+  void SetLife ( double v )       { life = v; }
+  void SetColor( std::int32_t v ) { color = v; }
+};
+
+DINJECT_CLASS(Particle) {
+  dinject::Class<Particle>("particle")
+    .AddPrimitive<double>      ("x",&Particle::SetX)
+    .AddPrimitive<double>      ("y",&Particle::SetY)
+    .AddPrimitive<double>      ("life",&Particle::SetLife)
+    .AddPrimitive<std::int32_t>("color",&Particle::SetColor);
+}
+
+// Total objects per second when each thread builds count objects , the
+// serialized version guards New with a global mutex which is what user had
+// to do before the registry can be frozen
+static double Throughput( const dinject::ConfigObject& config , int thread ,
+                          int count , bool serialized ) {
+  std::mutex lock;
+  std::vector<std::thread> threads;
+
+  auto start = std::chrono::steady_clock::now();
+  for( int t = 0 ; t < thread ; ++t ) {
+    threads.emplace_back([&]() {
+      for( int i = 0 ; i < count ; ++i ) {
+        if(serialized) {
+          std::lock_guard<std::mutex> guard(lock);
+          auto p = dinject::New<Particle>("particle",config);
+          bench::DoNotOptimize(p);
+        } else {
+          auto p = dinject::New<Particle>("particle",config);
+          bench::DoNotOptimize(p);
+        }
+      }
+    });
+  }
+  for( auto &t : threads ) t.join();
+  auto end = std::chrono::steady_clock::now();
+
+  double sec = std::chrono::duration<double>(end-start).count();
+  return static_cast<double>(thread) * count / sec;
+}
+
+int main() {
+  dinject::Freeze();
+
+  auto config = dinject::NewDefaultConfigObject();
+  config->Set("x",dinject::Val(1.0));
+  config->Set("y",dinject::Val(2.0));
+  config->Set("life",dinject::Val(3.0));
+  config->Set("color",dinject::Val(0xff00ff));
+
+  bench::Run("GetKlass frozen",1000000,[&]() {
+    auto k = dinject::detail::GetKlass("particle");
+    bench::DoNotOptimize(k);
+  });
+
+  int max_thread = static_cast<int>(std::thread::hardware_concurrency());
+  if(max_thread < 1) max_thread = 1;
+
+  const int kCount = 100000;
+  for( int t = 1 ; t <= max_thread ; t *= 2 ) {
+    double free = Throughput(*config,t,kCount,false);
+    double lock = Throughput(*config,t,kCount,true);
+    std::printf("New<Particle> %2d threads: frozen %12.0f obj/s , "
+                "mutex %12.0f obj/s\n",t,free,lock);
+
+    // recorded per object so it is comparable across thread counts
+    auto objects = static_cast<std::size_t>(t) * kCount;
+    char name[64];
+    std::snprintf(name,sizeof(name),"New<Particle> %d threads frozen",t);
+    bench::Record(name,objects,1e9 / free);
+    std::snprintf(name,sizeof(name),"New<Particle> %d threads mutex",t);
+    bench::Record(name,objects,1e9 / lock);
+  }
+  return 0;
+}
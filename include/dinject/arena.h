@@ -0,0 +1,96 @@
+#ifndef DINJECT_ARENA_H_
+#define DINJECT_ARENA_H_
+
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace dinject {
+
+/**
+ * A monotonic arena , memory is carved out of big blocks and is only given
+ * back when the arena is reset or destroyed. Objects created by New are
+ * destroyed in reverse order of creation when the arena is reset.
+ *
+ * It is also a std::pmr::memory_resource so an object built inside of the
+ * arena can allocate its own containers from the same arena.
+ *
+ * The arena is not thread safe , use one arena per thread.
+ */
+class Arena : public std::pmr::memory_resource {
+ public:
+  static const std::size_t kDefaultBlockSize = 64 * 1024;
+
+  explicit Arena( std::size_t block_size = kDefaultBlockSize );
+  virtual ~Arena();
+
+  // Allocate raw memory , the memory is not tracked by any finalizer
+  void* Allocate( std::size_t size , std::size_t alignment );
+
+  // Create an object inside of the arena , the destructor is invoked when
+  // the arena is reset or destroyed
+  template< typename T , typename... ARGS > T* New( ARGS&&... args );
+
+  // Destroy all objects and release all memory except the first block
+  void Reset();
+
+  // Bytes handed out by the arena since last reset
+  std::size_t size() const { return size_; }
+
+ protected:
+  virtual void* do_allocate( std::size_t size , std::size_t alignment ) {
+    return Allocate(size,alignment);
+  }
+
+  virtual void do_deallocate( void* , std::size_t , std::size_t ) {}
+
+  virtual bool do_is_equal( const std::pmr::memory_resource& other ) const
+    noexcept {
+    return this == &other;
+  }
+
+ private:
+  struct Block {
+    Block* next;
+    std::size_t size;
+  };
+
+  struct Finalizer {
+    void (*destroy)( void* );
+    void* object;
+    Finalizer* next;
+  };
+
+  template< typename T > static void Destroy( void* object ) {
+    static_cast<T*>(object)->~T();
+  }
+
+  void AddFinalizer( void (*destroy)( void* ) , void* object );
+  void NewBlock( std::size_t size );
+  void RunFinalizer();
+
+  Block* blocks_;
+  char* cursor_;
+  char* end_;
+  Finalizer* finalizers_;
+  std::size_t block_size_;
+  std::size_t size_;
+
+  Arena( const Arena& ) = delete;
+  Arena& operator = ( const Arena& ) = delete;
+};
+
+template< typename T , typename... ARGS > T* Arena::New( ARGS&&... args ) {
+  void* mem = Allocate(sizeof(T),alignof(T));
+  T* object = ::new (mem) T(std::forward<ARGS>(args)...);
+  if(!std::is_trivially_destructible<T>::value) {
+    AddFinalizer(&Destroy<T>,object);
+  }
+  return object;
+}
+
+} // namespace dinject
+
+#endif // DINJECT_ARENA_H_
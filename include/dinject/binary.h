@@ -0,0 +1,44 @@
+#ifndef DINJECT_BINARY_H_
+#define DINJECT_BINARY_H_
+
+#include <memory>
+#include <string>
+
+#include "dinject.h"
+
+namespace dinject {
+
+/**
+ * Compact binary format of a ConfigObject tree , designed to be memory
+ * mapped and read in place.
+ *
+ * All references are offsets from the start of the file , keys are stored
+ * once in a key table and entries refer to them by index , primitives are
+ * stored inline in the entry. The returned ConfigObject is a view over the
+ * mapped file: ForEach never allocates , nested objects are handed out as
+ * non-owning views and strings are passed by VisitString without a copy.
+ * Get materializes the value on first access of each key since it has to
+ * return a ConfigValue pointer , a nested object returned by Get is only
+ * valid as long as the view it comes from.
+ *
+ * The file is in native byte order and is validated once when it is opened ,
+ * the view is read only and Set is a fatal error.
+ */
+
+// Serialize the config tree into binary format
+bool WriteBinaryConfig( const ConfigObject& config , std::string* output );
+bool WriteBinaryConfig( const ConfigObject& config , const char* path );
+
+// Memory map a binary config file , returns null and sets error if the file
+// cannot be mapped or is not valid. The mapping lives as long as any object
+// returned from the view
+std::shared_ptr<ConfigObject> OpenBinaryConfig( const char* path ,
+                                                std::string* error = NULL );
+
+// Same as OpenBinaryConfig but the data is held in memory
+std::shared_ptr<ConfigObject> LoadBinaryConfig( std::string data ,
+                                                std::string* error = NULL );
+
+} // namespace dinject
+
+#endif // DINJECT_BINARY_H_
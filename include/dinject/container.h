@@ -0,0 +1,134 @@
+#ifndef DINJECT_CONTAINER_H_
+#define DINJECT_CONTAINER_H_
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#include "dinject.h"
+
+namespace dinject {
+
+/**
+ * A Container holds named instances which are shared between objects
+ * instead of being built again for each of them.
+ *
+ * An instance is registered with a class name , a config and a scope. In
+ * any config built through the container , a string value "@name" of an
+ * attribute added with AddShared refers to the instance :
+ *
+ *   kSingleton  built once on first reference and kept by the container
+ *   kPerBuild   built once per Container::New , shared inside of the graph
+ *   kTransient  built on every reference
+ *
+ * The configs of registered instances can refer to other instances as well ,
+ * a singleton never captures a per build instance of the build that created
+ * it since its dependencies are resolved in its own scope. A circular
+ * reference is a fatal error.
+ *
+ * Register must be called before any build , New and Get can be called from
+ * multiple threads , singletons are created under a lock.
+ */
+class Container {
+ public:
+  enum Scope {
+    kSingleton,
+    kPerBuild,
+    kTransient
+  };
+
+  Container();
+  ~Container();
+
+  // Register a named instance of class klass built from config , an old one
+  // with the same name is replaced
+  void Register( const char* name , const char* klass ,
+                 std::shared_ptr<ConfigObject> config ,
+                 Scope scope = kSingleton );
+
+  // Register an already built object as a singleton
+  template< typename T >
+  void RegisterInstance( const char* name , std::shared_ptr<T> object ) {
+    AddInstance(name,detail::SharedRef(std::move(object),
+                                       detail::GetTypeId<T>()));
+  }
+
+  // Resolve the named instance , null if the name is not registered
+  template< typename T > std::shared_ptr<T> Get( const char* name );
+
+  // Same as dinject::New but references in the config are resolved
+  template< typename T >
+  std::unique_ptr<T> New( const char* klass , const ConfigObject& config );
+
+ private:
+  struct Entry;
+
+  void AddInstance( const char* name , detail::SharedRef&& instance );
+
+  // NULL if not found
+  Entry* Find( std::string_view name );
+
+  detail::SharedRef Resolve( Entry* entry , detail::BuildScope* scope );
+  detail::SharedRef Create ( Entry* entry , detail::BuildScope* scope );
+
+  // std::less<> makes Find by std::string_view not create a std::string
+  std::map<std::string,std::unique_ptr<Entry>,std::less<>> entries_;
+
+  // Guards entries_ and the creation of singletons , a singleton can refer
+  // to another one while it is being created
+  std::recursive_mutex lock_;
+
+  friend detail::SharedRef detail::ResolveReference( Container* ,
+                                                     std::string_view ,
+                                                     detail::BuildScope* );
+
+  Container( const Container& ) = delete;
+  Container& operator = ( const Container& ) = delete;
+};
+
+namespace detail {
+
+// Per build instances of a Container::New
+struct BuildScope {
+  // Keyed by the registered entry
+  std::unordered_map<const void*,SharedRef> instances;
+
+  // Entries being created in this scope , used to find circular reference
+  std::vector<const void*> building;
+};
+
+} // namespace detail
+
+template< typename T >
+std::shared_ptr<T> Container::Get( const char* name ) {
+  if(!Find(name)) return std::shared_ptr<T>();
+  auto ref = detail::ResolveReference(this,name,NULL);
+  auto ptr = ref.As<T>();
+  if(!ptr && ref.ptr) {
+    detail::Fatal("You are trying to get instance %s as type %s , but it is "
+                  "not the registered type",name,typeid(T).name());
+  }
+  return ptr;
+}
+
+template< typename T >
+std::unique_ptr<T> Container::New( const char* klass ,
+                                   const ConfigObject& config ) {
+  detail::BuilderStorage storage;
+  auto kb = detail::NewKlassObject(FindSymbol(klass),&storage);
+  if(!kb) return std::unique_ptr<T>();
+  detail::BuildScope scope;
+  detail::BuildContext context;
+  context.container = this;
+  context.scope     = &scope;
+  detail::Build(kb,config,&context);
+  return kb->Get<T>();
+}
+
+} // namespace dinject
+
+#endif // DINJECT_CONTAINER_H_
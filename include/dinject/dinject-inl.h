@@ -4,14 +4,90 @@
 namespace dinject {
 
 namespace detail {
+
+struct BuildScope;
+
+// State shared by a whole build of an object graph
+struct BuildContext {
+  // If not NULL , nested objects are created inside of the arena
+  Arena* arena;
+
+  // If not NULL , sibling nested objects are built in parallel
+  Executor* executor;
+
+  // If not NULL , a string value "@name" of an object attribute is resolved
+  // to the named instance of the container , per build instances are kept
+  // in the scope
+  Container* container;
+  BuildScope* scope;
+
+  // If not NULL , nested objects of memoizable classes are looked up by the
+  // content of their config before being built
+  MemoCache* memo;
+
+  // If not NULL , a value which doesn't match the type of its attribute
+  // stops the build and is reported here instead of aborting , see
+  // result.h. Serial build only
+  BuildError* error;
+  bool failed;
+
+  BuildContext() :
+    arena(NULL), executor(NULL), container(NULL), scope(NULL), memo(NULL),
+    error(NULL), failed(false) {}
+};
+
+// Build the object attribute through the memo cache of the context , returns
+// false if the class of the attribute is not memoized. See memo.h
+bool BuildMemo( Attribute* attr , const ConfigObject& config ,
+                BuildContext* context , Value* output );
+
+// Resolve the named instance of the container , see container.h
+SharedRef ResolveReference( Container* container , std::string_view name ,
+                                                   BuildScope* scope );
+
 void Build( KlassBuilder* builder , const ConfigObject& config );
+void Build( KlassBuilder* builder , const ConfigObject& config ,
+                                    BuildContext* context );
+
+// Convert a primitive ConfigValue into Value, returns false if the
+// ConfigValue is a nested ConfigObject
+bool ConvertPrimitive( const ConfigValue& config , Value* output );
 } // namespace detail
 
 template< typename T >
 std::unique_ptr<T> New( const char* name , const ConfigObject& config ) {
-  auto kb = detail::NewKlassObject(name);
+  detail::BuilderStorage storage;
+  auto kb = detail::NewKlassObject(FindSymbol(name),&storage);
+  if(!kb) return std::unique_ptr<T>();
+  detail::Build(kb,config);
+  return kb->Get<T>();
+}
+
+template< typename T >
+T* New( const char* name , const ConfigObject& config , Arena& arena ) {
+  detail::BuilderStorage storage;
+  auto kb = detail::NewKlassObject(FindSymbol(name),&arena,&storage);
+  if(!kb) return NULL;
+  detail::BuildContext context;
+  context.arena = &arena;
+  detail::Build(kb,config,&context);
+  auto ptr = kb->Get<T>();
+  return ptr.release();
+}
+
+template< typename T >
+std::unique_ptr<T> NewParallel( const char* name , const ConfigObject& config ,
+                                                   Executor& executor ) {
+  if(!detail::IsFrozen()) {
+    detail::Fatal("NewParallel requires the class registry to be frozen , "
+                  "call dinject::Freeze() first");
+  }
+  detail::BuilderStorage storage;
+  auto kb = detail::NewKlassObject(FindSymbol(name),&storage);
   if(!kb) return std::unique_ptr<T>();
-  detail::Build(kb.get(),config);
+  detail::BuildContext context;
+  context.executor = &executor;
+  detail::Build(kb,config,&context);
   return kb->Get<T>();
 }
 
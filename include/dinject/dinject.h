@@ -2,13 +2,18 @@
 #define DINJECT_H_
 
 #include <cstdint>
+#include <string_view>
 #include <variant>
 
 #include "meta.h"
 
 namespace dinject {
 
+struct BuildError;
 class ConfigObject;
+class Container;
+class Executor;
+class MemoCache;
 
 /**
  * Here I define a simple DSL inside of C++ to do meta data building
@@ -26,6 +31,13 @@ template< typename T >
   return ::dinject::detail::NewKlass<T>(name);
 }
 
+// Freeze the class registry once all classes are registered , normally at
+// the start of main before any worker thread is created. After that the
+// registry is immutable , registering a class is a fatal error and New can
+// be called from any thread concurrently without locking. Before Freeze
+// the registry must only be used by one thread
+inline void Freeze() { ::dinject::detail::FreezeKlass(); }
+
 // Exported macro interfaces
 #include "macro-interface.h"
 #define DINJECT_CLASS _DINJECT_CLASS_V0
@@ -57,9 +69,44 @@ class ConfigObject {
     virtual bool HasNext() const = 0;
     virtual bool Next()    = 0;
     virtual void Get ( std::string* , ConfigValue* ) = 0;
+
+    // Pre-interned Symbol of the current key. An implementation which
+    // interns its keys (see FindSymbol) allows the build path to resolve
+    // attributes by integer instead of string , kNoSymbol means the key is
+    // not interned and it is resolved by name
+    virtual Symbol GetSymbol() const { return kNoSymbol; }
   };
 
   virtual std::unique_ptr<Iterator> NewIterator() const = 0;
+
+  // Allocation free iteration , the key and value are borrowed from the
+  // ConfigObject and are only valid during the Visit call
+  class Visitor {
+   public:
+    virtual ~Visitor() {}
+
+    // Symbol is the pre-interned key , same as Iterator::GetSymbol
+    virtual void Visit( std::string_view key , Symbol symbol ,
+                                               const ConfigValue& value ) = 0;
+
+    // String value borrowed from a ConfigObject which doesn't store
+    // std::string , e.g. a memory mapped one. The default one wraps it into
+    // a ConfigValue , visitor can override it to avoid the copy
+    virtual void VisitString( std::string_view key , Symbol symbol ,
+                                                     std::string_view value ) {
+      Visit(key,symbol,ConfigValue(std::string(value)));
+    }
+
+    // Whether the visitor needs the value of key. A ConfigObject which
+    // parses lazily doesn't parse the value of an unwanted key , the build
+    // path only wants keys which are attributes of the class
+    virtual bool Wants( std::string_view , Symbol ) { return true; }
+  };
+
+  // Visit all entries in the same order as NewIterator. The default one is
+  // implemented with NewIterator and copies each entry , implementation
+  // should override it to visit its storage directly
+  virtual void ForEach( Visitor* visitor ) const;
 };
 
 // Helper to create a simple ConfigObject with a std::map, used for
@@ -70,6 +117,23 @@ std::shared_ptr<ConfigObject> NewDefaultConfigObject();
 template< typename T > std::unique_ptr<T>
 New( const char* name , const ConfigObject& );
 
+// Create an object of type T inside of the arena , all nested objects are
+// created inside of the arena as well except the ones of AddShared
+// attributes , which are owned by their std::shared_ptr. The returned object
+// is owned by the arena , so object attribute setters of the classes must
+// not take the ownership of the passed in pointer
+template< typename T >
+T* New( const char* name , const ConfigObject& , Arena& arena );
+
+// Create an object of type T , sibling nested objects are built in parallel
+// on the executor. The setters of each object are still invoked in config
+// order from one thread at a time , but constructors and setters of sibling
+// objects run concurrently so they must not share unsynchronized state.
+// The registry must be frozen with Freeze() first
+template< typename T >
+std::unique_ptr<T> NewParallel( const char* name , const ConfigObject& ,
+                                Executor& executor );
+
 
 // Helper to create ConfigValue , Val(1) , Val(true) , Val(false)
 
@@ -0,0 +1,97 @@
+#ifndef DINJECT_EXECUTOR_H_
+#define DINJECT_EXECUTOR_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dinject {
+
+typedef std::function<void()> Task;
+
+// Interface used by parallel build to run tasks
+class Executor {
+ public:
+  virtual ~Executor() {}
+
+  // Schedule a task , it can run on any thread
+  virtual void Submit( Task task ) = 0;
+
+  // Run one pending task on the calling thread , returns false if there is
+  // no task. A thread waiting for its tasks uses it to help instead of block
+  virtual bool RunOne() = 0;
+
+  // Number of threads that can run tasks at the same time
+  virtual std::size_t concurrency() const = 0;
+};
+
+/**
+ * Work stealing thread pool. Each worker has its own deque , a task
+ * submitted from a worker goes to its own deque and is popped LIFO , idle
+ * workers steal FIFO from others. Tasks submitted from outside of the pool
+ * go to a shared deque.
+ */
+class ThreadPool : public Executor {
+ public:
+  // Create thread workers , 0 means std::thread::hardware_concurrency()-1
+  // since the thread waiting for result also runs tasks
+  explicit ThreadPool( std::size_t thread );
+  virtual ~ThreadPool();
+
+  virtual void Submit( Task task );
+  virtual bool RunOne();
+  virtual std::size_t concurrency() const { return workers_.size() + 1; }
+
+ private:
+  struct Queue {
+    std::mutex lock;
+    std::deque<Task> tasks;
+  };
+
+  // Index of the queue of calling thread
+  std::size_t QueueIndex() const;
+
+  bool Pop  ( std::size_t index , Task* task );
+  bool Steal( std::size_t index , Task* task );
+  void Work ( std::size_t index );
+
+  // one queue per worker and the last one is for external thread
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::vector<std::thread> workers_;
+
+  std::mutex sleep_lock_;
+  std::condition_variable wakeup_;
+  std::atomic<std::size_t> pending_;
+  std::atomic<bool> stop_;
+
+  ThreadPool( const ThreadPool& ) = delete;
+  ThreadPool& operator = ( const ThreadPool& ) = delete;
+};
+
+// A group of tasks that can be waited for , the waiting thread keeps
+// running tasks of the executor so nested groups never deadlock
+class TaskGroup {
+ public:
+  explicit TaskGroup( Executor* executor ):
+    executor_(executor), pending_(0)
+  {}
+
+  ~TaskGroup() { Wait(); }
+
+  void Run( Task task );
+  void Wait();
+
+ private:
+  Executor* executor_;
+  std::atomic<std::size_t> pending_;
+};
+
+} // namespace dinject
+
+#endif // DINJECT_EXECUTOR_H_
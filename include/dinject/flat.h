@@ -0,0 +1,99 @@
+#ifndef DINJECT_FLAT_H_
+#define DINJECT_FLAT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "dinject.h"
+
+namespace dinject {
+
+/**
+ * A ConfigObject stored in flat arrays instead of a std::map.
+ *
+ * Keys , symbols and values live in three parallel vectors sorted by key ,
+ * so a lookup only touches the key array and iteration is a linear walk in
+ * the same order as the default config object. Keys up to kInlineKey bytes
+ * are stored inline , longer keys go into one shared pool. Once an object
+ * has kIndexThreshold keys a hash index is built next to the arrays.
+ *
+ * For bulk construction call Reserve , then Append in any order and Seal
+ * once. Append does not sort or check duplicates , Seal sorts the entries
+ * and the last appended value of a duplicated key wins. Reading an object
+ * which is not sealed is a fatal error. Set works on a sealed object but
+ * inserting a new key is O(n) , use Append for large objects.
+ *
+ * Unlike the default config object the pointer returned by Get is only
+ * valid until the next Set of a new key , Append or Seal.
+ */
+class FlatConfigObject : public ConfigObject {
+ public:
+  static const std::size_t kInlineKey      = 16;
+  static const std::size_t kIndexThreshold = 32;
+
+  FlatConfigObject();
+  virtual ~FlatConfigObject() {}
+
+  // Bulk construction
+  void Reserve( std::size_t count );
+  void Append ( std::string_view key , const ConfigValue& value );
+  void Append ( std::string_view key , ConfigValue&& value );
+  void Seal   ();
+
+  bool        sealed() const { return sealed_; }
+  std::size_t size  () const { return values_.size(); }
+
+  virtual const ConfigValue* Get( const char* ) const;
+  virtual const ConfigValue* Get( const std::string& ) const;
+
+  virtual void Set( const char* , const ConfigValue& );
+  virtual void Set( const std::string& , const ConfigValue& );
+
+  virtual std::unique_ptr<Iterator> NewIterator() const;
+  virtual void ForEach( Visitor* visitor ) const;
+
+  // Key of the ith entry in sorted order
+  std::string_view key( std::size_t i ) const { return KeyView(keys_[i]); }
+
+ private:
+  struct Key {
+    std::uint32_t size;
+    std::uint32_t hash;
+    union {
+      char        data[kInlineKey];
+      std::size_t offset;             // into pool_ if size > kInlineKey
+    };
+  };
+
+  std::string_view KeyView( const Key& k ) const {
+    return k.size <= kInlineKey ? std::string_view(k.data,k.size) :
+                                  std::string_view(pool_.data() + k.offset,
+                                                   k.size);
+  }
+
+  Key  NewKey     ( std::string_view key );
+  void CheckSealed() const;
+  void BuildIndex ();
+
+  // Index of the key , size() if not found
+  std::size_t Find( std::string_view key ) const;
+
+  std::vector<Key>           keys_;
+  std::vector<Symbol>        symbols_;
+  std::vector<ConfigValue>   values_;
+  std::string                pool_;
+  std::vector<std::uint32_t> index_;   // slot holds entry index + 1 , 0 is empty
+  bool                       sealed_;
+
+  friend class FlatConfigObjectIterator;
+};
+
+std::shared_ptr<FlatConfigObject> NewFlatConfigObject();
+
+} // namespace dinject
+
+#endif // DINJECT_FLAT_H_
@@ -0,0 +1,79 @@
+#ifndef DINJECT_JSON_H_
+#define DINJECT_JSON_H_
+
+#include <istream>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "dinject.h"
+
+namespace dinject {
+
+/**
+ * Streaming JSON front end. The document is tokenized and injected into the
+ * builder in one pass , nested objects are created through NewKlassObject as
+ * soon as their '{' is read. No ConfigObject tree is built , memory used is
+ * bounded by the nesting depth and the longest string , not the document.
+ *
+ * The document must be an object. Keys not known by the class , null and
+ * arrays are skipped since they have no attribute to map to. Syntax errors
+ * are reported through error and the partially built object is destroyed ,
+ * type mismatch between a value and its attribute is fatal like New.
+ */
+
+namespace detail {
+
+// Parse the JSON object and inject it into builder , returns false on
+// syntax error and error is set if it is not NULL
+bool BuildJson( KlassBuilder* builder , std::string_view json ,
+                                        std::string* error );
+
+// Same as above but the document is read from input in chunks
+bool BuildJson( KlassBuilder* builder , std::istream& input ,
+                                        std::string* error );
+
+template< typename T , typename INPUT >
+std::unique_ptr<T> NewFromJson( const char* name , INPUT& input ,
+                                                   std::string* error ) {
+  BuilderStorage storage;
+  auto kb = NewKlassObject(FindSymbol(name),&storage);
+  if(!kb) {
+    if(error) *error = std::string("class ") + name + " is not found";
+    return std::unique_ptr<T>();
+  }
+  if(!BuildJson(kb,input,error)) return std::unique_ptr<T>();
+  return kb->Get<T>();
+}
+
+} // namespace detail
+
+// Create an object of class name from a JSON document held in memory
+template< typename T >
+std::unique_ptr<T> NewFromJson( const char* name , std::string_view json ,
+                                std::string* error = NULL ) {
+  return detail::NewFromJson<T>(name,json,error);
+}
+
+// Create an object of class name from a JSON document read from a stream ,
+// the stream is consumed in fixed size chunks so huge documents never need
+// to be held in memory
+template< typename T >
+std::unique_ptr<T> NewFromJson( const char* name , std::istream& input ,
+                                std::string* error = NULL ) {
+  return detail::NewFromJson<T>(name,input,error);
+}
+
+// Create a ConfigObject over JSON text which is parsed lazily. The keys of
+// an object are indexed when it is first accessed , nested objects and
+// strings are only skipped over by their brackets and quotes and are parsed
+// when Get or ForEach reaches them , ForEach skips the keys its visitor
+// doesn't want. Only the top level is validated up front , returns null and
+// sets error on syntax error there. A syntax error inside of a nested value
+// is fatal once the value is reached. Arrays and null are dropped
+std::shared_ptr<ConfigObject> NewLazyJsonConfigObject( std::string text ,
+                                                       std::string* error = NULL );
+
+} // namespace dinject
+
+#endif // DINJECT_JSON_H_
@@ -22,4 +22,7 @@
 #define _DINJECT_FRIEND_REGISTRY_V0(X) \
   friend class _DINJECT_CLASS_REGISTRY_NAME(X)
 
+#define _DINJECT_STATIC_CLASS_V0(X) \
+  template<> struct dinject::StaticClass<X>
+
 #endif // DINJECT_MACRO_INTERFACE_H_
@@ -0,0 +1,108 @@
+#ifndef DINJECT_MEMO_H_
+#define DINJECT_MEMO_H_
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "dinject.h"
+
+namespace dinject {
+
+/**
+ * Cache of nested objects keyed by the content of their config.
+ *
+ * When an object is built with a MemoCache , each nested config of an object
+ * attribute whose class is marked with Memoize or Immutable is hashed
+ * together with the class. If an identical config of the same class has
+ * been built before , the object is not built again :
+ *
+ *   Immutable and the attribute is added with AddShared , the cached object
+ *   is shared
+ *
+ *   Memoize , the cached object is copied with its copy constructor
+ *
+ * The config is serialized into a flat key which is hashed and compared ,
+ * this is cheaper than building the object but it is not free , only mark
+ * classes whose configs repeat a lot. Configs with the same content but a
+ * different key order are not identical.
+ *
+ * The cache is bounded by capacity bytes and least recently used entries are
+ * evicted. The size of an entry is estimated as sizeof the object plus the
+ * size of the key , memory owned by the object itself is not known.
+ * A MemoCache can be used by multiple threads at the same time.
+ */
+class MemoCache {
+ public:
+  struct Stats {
+    std::size_t hit;
+    std::size_t miss;
+    std::size_t evict;
+    std::size_t count;      // number of cached objects
+    std::size_t bytes;      // estimated size of the cached objects
+  };
+
+  explicit MemoCache( std::size_t capacity );
+  ~MemoCache();
+
+  Stats stats() const;
+
+  std::size_t capacity() const { return capacity_; }
+
+  // Drop all cached objects , the statistics are kept
+  void Clear();
+
+ private:
+  struct Entry {
+    std::size_t hash;
+    Symbol klass;
+    std::string key;          // serialized config
+    detail::SharedRef object;
+    std::size_t bytes;
+  };
+
+  typedef std::list<Entry> EntryList;
+
+  // Null if not found , a found entry becomes the most recently used one
+  detail::SharedRef Find( std::size_t hash , Symbol klass ,
+                          const std::string& key );
+
+  void Add( std::size_t hash , Symbol klass , std::string&& key ,
+            const detail::SharedRef& object , std::size_t object_size );
+
+  void Evict();
+
+  std::size_t capacity_;
+
+  mutable std::mutex lock_;
+  EntryList lru_;                                    // front is the newest
+  std::unordered_multimap<std::size_t,EntryList::iterator> index_;
+  Stats stats_;
+
+  friend bool detail::BuildMemo( detail::Attribute* , const ConfigObject& ,
+                                 detail::BuildContext* , detail::Value* );
+
+  MemoCache( const MemoCache& ) = delete;
+  MemoCache& operator = ( const MemoCache& ) = delete;
+};
+
+// Same as dinject::New but nested objects of memoized classes go through
+// the cache
+template< typename T >
+std::unique_ptr<T> New( const char* name , const ConfigObject& config ,
+                                           MemoCache& memo ) {
+  detail::BuilderStorage storage;
+  auto kb = detail::NewKlassObject(FindSymbol(name),&storage);
+  if(!kb) return std::unique_ptr<T>();
+  detail::BuildContext context;
+  context.memo = &memo;
+  detail::Build(kb,config,&context);
+  return kb->Get<T>();
+}
+
+} // namespace dinject
+
+#endif // DINJECT_MEMO_H_
@@ -1,14 +1,22 @@
 #ifndef DINJECT_META_H_
 #define DINJECT_META_H_
+#include "arena.h"
 #include "error.h"
+#include "profile.h"
+#include "symbol.h"
+#include "trace.h"
 
 #include <typeinfo>
 #include <cassert>
+#include <cstddef>
 #include <cstring>
 #include <memory>
-#include <any>
+#include <new>
+#include <utility>
 #include <variant>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <cstdint>
 #include <vector>
 
@@ -18,6 +26,7 @@ namespace detail {
 class Attribute;
 class Klass;
 class KlassBuilder;
+class BuilderStorage;
 
 #define DINJECT_PRIMITIVE_TYPE(__)                      \
   __(kTypeBool   ,bool         ,"bool" ,bool)           \
@@ -36,8 +45,8 @@ class KlassBuilder;
   __(kTypeString ,std::string  ,"string",std::string)
 
 #define DINJECT_OBJECT_TYPE(__)                         \
-  __(kTypeStruct,std::any,"object",std::any)            \
-  __(kTypeObject  ,std::any,"object",std::any)
+  __(kTypeStruct,ObjectRef,"object",ObjectRef)          \
+  __(kTypeObject  ,ObjectRef,"object",ObjectRef)
 
 #define DINJECT_CPP_TYPE(__)             \
   DINJECT_PRIMITIVE_TYPE(__)             \
@@ -56,6 +65,65 @@ DINJECT_CPP_TYPE(__)
 
 const char* GetCppTypeName( CppType );
 
+// Compact id of a registered C++ type , assigned when the type is first
+// registered with Class<T>(). Comparing TypeId replaces RTTI when an object
+// is handed over between builders
+typedef std::uint32_t TypeId;
+
+static const TypeId kNoTypeId = 0;
+
+// Allocate a new TypeId
+TypeId NewTypeId();
+
+template< typename T > struct KlassTypeId {
+  // constant initialized , so it is kNoTypeId before any registration
+  static TypeId value;
+};
+
+template< typename T > TypeId KlassTypeId<T>::value = kNoTypeId;
+
+// Get the TypeId of T , assign one if T doesn't have one yet
+template< typename T > TypeId GetTypeId() {
+  auto &id = KlassTypeId<T>::value;
+  if(id == kNoTypeId) id = NewTypeId();
+  return id;
+}
+
+// Typed raw pointer of an object created by a KlassBuilder
+struct ObjectRef {
+  void* ptr;
+  TypeId type;
+
+  ObjectRef() : ptr(NULL), type(kNoTypeId) {}
+  ObjectRef( void* p , TypeId t ) : ptr(p), type(t) {}
+
+  template< typename T > static ObjectRef Of( T* object ) {
+    return ObjectRef(object,KlassTypeId<T>::value);
+  }
+
+  // Returns NULL if the object is not of type T
+  template< typename T > T* As() const {
+    return (type == KlassTypeId<T>::value && type != kNoTypeId) ?
+      static_cast<T*>(ptr) : NULL;
+  }
+};
+
+// Typed shared pointer of an object which is shared by several owners , e.g.
+// an instance resolved by reference from a Container
+struct SharedRef {
+  std::shared_ptr<void> ptr;
+  TypeId type;
+
+  SharedRef() : ptr(), type(kNoTypeId) {}
+  SharedRef( std::shared_ptr<void> p , TypeId t ) : ptr(std::move(p)), type(t) {}
+
+  // Returns null if the object is not of type T
+  template< typename T > std::shared_ptr<T> As() const {
+    return (type == KlassTypeId<T>::value && type != kNoTypeId) ?
+      std::static_pointer_cast<T>(ptr) : std::shared_ptr<T>();
+  }
+};
+
 #define DINJECT_VALUE_PRIMITIVE_TYPE(__)               \
   __(bool)                                             \
   __(std::int64_t)                                     \
@@ -70,7 +138,8 @@ typedef std::variant<
 DINJECT_VALUE_PRIMITIVE_TYPE(__)
 #undef __ // __
 
-  std::any> Value;
+  ObjectRef,
+  SharedRef> Value;
 
 template< typename T >
 struct MapPrimitiveCppTypeToUniversalType {};
@@ -95,115 +164,408 @@ DINJECT_PRIMITIVE_TYPE(__)
 
 #undef DO // DO
 
+// Get a value of universal type T out of a Value or ConfigValue , returns
+// false if the value doesn't match. An integer is accepted as a double ,
+// text formats like JSON write 15 for a real number as well
+template< typename T , typename V >
+bool GetPrimitive( const V& value , T* output ) {
+  if(auto v = std::get_if<T>(&value)) {
+    *output = *v;
+    return true;
+  }
+  if constexpr (std::is_same<T,double>::value) {
+    if(auto v = std::get_if<std::int64_t>(&value)) {
+      *output = static_cast<double>(*v);
+      return true;
+    }
+  }
+  return false;
+}
+
+// Size in bytes of a primitive type , 0 if the type is not primitive
+std::size_t GetCppTypeSize( CppType );
+
+// Store value into a field of type at address , returns false if the value
+// doesn't match the type
+inline bool StoreField( void* address , CppType type , const Value& value ) {
+  switch(type) {
+#define __(A,B,C,D)                                      \
+    case A: {                                            \
+      D v = D();                                         \
+      if(!GetPrimitive(value,&v)) return false;          \
+      *static_cast<B*>(address) = static_cast<B>(v);     \
+      return true;                                       \
+    }
+    DINJECT_PRIMITIVE_TYPE(__)
+#undef __ // __
+    case kTypeString: {
+      auto v = std::get_if<std::string>(&value);
+      if(!v) return false;
+      *static_cast<std::string*>(address) = *v;
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+inline bool StoreField( void* address , CppType type , Value&& value ) {
+  if(type == kTypeString) {
+    auto v = std::get_if<std::string>(&value);
+    if(!v) return false;
+    *static_cast<std::string*>(address) = std::move(*v);
+    return true;
+  }
+  return StoreField(address,type,static_cast<const Value&>(value));
+}
+
+// FNV-1a hash of an attribute name , computed once when the attribute is
+// registered and once per lookup
+inline std::uint32_t HashName( std::string_view name ) {
+  std::uint32_t h = 2166136261u;
+  for( auto c : name ) {
+    h ^= static_cast<unsigned char>(c);
+    h *= 16777619u;
+  }
+  return h;
+}
+
+// Called whenever a Klass's attribute list or parent list is changed , which
+// invalidates all sealed attribute table
+void InvalidateKlassTable();
+
 // Object to record injected information for a certain class
 class Klass : public std::enable_shared_from_this<Klass> {
  public:
-  Klass( const char* name ) : name_(name), parents_() , attributes_ () {}
+  Klass( const char* name , TypeId type_id ) :
+    name_(name),
+    symbol_(Intern(name)),
+    type_id_(type_id),
+    parents_() ,
+    attributes_ () ,
+    clone_(NULL),
+    destroy_(NULL),
+    object_size_(0),
+    immutable_(false),
+    table_(),
+    symbol_table_(),
+    table_mask_(0),
+    table_epoch_(0)
+  {}
 
   virtual ~Klass() {}
 
   const char* name() const { return name_; }
+  Symbol    symbol() const { return symbol_; }
+
+  // TypeId of the C++ type this Klass creates
+  TypeId   type_id() const { return type_id_; }
 
   // Factory class to create a specialized KlassBuilder object
   virtual std::unique_ptr<KlassBuilder> New() = 0;
 
+  // Create a KlassBuilder inside of the storage , which is normally on the
+  // stack of the caller. The object is allocated on heap
+  virtual KlassBuilder* New( BuilderStorage* storage ) = 0;
+
+  // Create a KlassBuilder inside of the storage whose object is placed
+  // inside of the arena , the object is destroyed when arena is reset
+  virtual KlassBuilder* New( Arena* arena , BuilderStorage* storage ) = 0;
+
   // Get list of parent
   const std::vector<std::shared_ptr<Klass>>& parents() const {
     return parents_;
   }
 
+  // Find attribute declared by this Klass only
   Attribute* FindAttribute( const char* name ) const;
 
+  // Find attribute declared by this Klass or any of its parents, the
+  // parents are searched in breadth first order. The lookup goes through
+  // the sealed attribute table and the Klass is sealed on demand
+  Attribute* ResolveAttribute( std::string_view name ) const;
+  Attribute* ResolveAttribute( Symbol symbol ) const;
+
+  // Flatten attributes of this Klass and all its parents into one open
+  // addressing hash table , after that ResolveAttribute is O(1) and doesn't
+  // allocate. Any later registration invalidates the table and it will be
+  // rebuilt on next lookup
+  void Seal() const;
+
+  // Whether the attribute table is up to date
+  bool sealed() const;
+
+  // Whether objects built from identical configs can be copied from a
+  // memoized one , see MemoCache
+  bool memoizable() const { return clone_ != NULL; }
+
+  // Whether objects are never modified after being built , so one object
+  // can be shared by all identical configs
+  bool immutable() const { return immutable_; }
+
+  // sizeof the C++ object , 0 if the class is neither memoizable nor
+  // immutable
+  std::size_t object_size() const { return object_size_; }
+
+  // Copy the object , the Klass must be memoizable
+  ObjectRef Clone( const void* object ) const {
+    assert(clone_);
+    return ObjectRef(clone_(object),type_id_);
+  }
+
+  // Delete a copy made by Clone which is not taken by any setter
+  void Destroy( const ObjectRef& object ) const {
+    assert(destroy_);
+    destroy_(object.ptr);
+  }
+
  protected:
   // Name of the Klass object
   const char* name_;
 
+  // Interned name of the Klass object
+  Symbol symbol_;
+
+  // TypeId of the C++ type
+  TypeId type_id_;
+
   // List of base class of Klass
   std::vector<std::shared_ptr<Klass>> parents_;
 
   // List of attributes for this Klass
   std::vector<std::unique_ptr<Attribute>> attributes_;
+
+  // Copy and delete function of a memoizable Klass
+  void* (*clone_)( const void* );
+  void  (*destroy_)( void* );
+  std::size_t object_size_;
+  bool immutable_;
+
+ private:
+  struct AttributeSlot {
+    std::uint32_t hash;
+    Attribute* attr;
+  };
+
+  struct SymbolSlot {
+    Symbol symbol;
+    Attribute* attr;
+  };
+
+  // Flattened attributes table of this Klass and its parents , size is
+  // always power of 2 and at least half empty. The symbol table has the
+  // same size and is keyed by the interned attribute name
+  mutable std::vector<AttributeSlot> table_;
+  mutable std::vector<SymbolSlot> symbol_table_;
+  mutable std::uint32_t table_mask_;
+  mutable std::uint64_t table_epoch_;
+};
+
+// Attribute of the key resolved in ConfigObject::Visitor::Wants. A
+// ConfigObject visits a key right after the visitor wants it , so Visit
+// takes the attribute from here instead of looking up the key again
+class WantedAttribute {
+ public:
+  WantedAttribute() : key_(), symbol_(kNoSymbol), attr_(NULL) {}
+
+  Attribute* Set( std::string_view key , Symbol symbol , Attribute* attr ) {
+    key_    = key;
+    symbol_ = symbol;
+    attr_   = attr;
+    return attr;
+  }
+
+  // Whether the attribute of the key is cached , it is taken only once
+  bool Take( std::string_view key , Symbol symbol , Attribute** output ) {
+    if(!key_.data() || key_.data() != key.data() ||
+       key_.size() != key.size() || symbol_ != symbol) {
+      return false;
+    }
+    *output = attr_;
+    key_ = std::string_view();
+    return true;
+  }
+
+ private:
+  std::string_view key_;
+  Symbol symbol_;
+  Attribute* attr_;
 };
 
 // Used to perform reflection for setting each attributes
 class KlassBuilder {
  public:
-  KlassBuilder( const std::shared_ptr<Klass>& c ): klass_ (c) {}
+  KlassBuilder( Klass* c , void* address = NULL ):
+    klass_ (c), address_(address)
+  {}
 
   virtual ~KlassBuilder() {}
 
-  // Build the primitive attribute
-  virtual void Build( const char* , Value&& )  = 0;
-  virtual void Build( Attribute*   , Value&& ) = 0;
-  virtual std::unique_ptr<KlassBuilder> BuildStruct( Attribute* )   = 0;
+  // Build the attribute , returns false if the value doesn't match the
+  // type of the attribute and then the setter is not invoked. Building an
+  // unknown attribute by name is ignored
+  virtual bool Build( const char* , Value&& )  = 0;
+  virtual bool Build( Attribute*   , Value&& ) = 0;
+  virtual bool Build( Attribute*   , const Value& ) = 0;
+
+  // Create a builder for the struct attribute inside of the storage , the
+  // builder is valid until the storage is destroyed or reused
+  virtual KlassBuilder* BuildStruct( Attribute* , BuilderStorage* ) = 0;
 
   // Find the attribute based on the name
-  Attribute* FindAttribute( const char* );
+  Attribute* FindAttribute( std::string_view );
+  Attribute* FindAttribute( Symbol );
 
   // Get the corresponding Klass object
-  const Klass* klass() const { return klass_.get(); }
+  const Klass* klass() const { return klass_; }
+
+  // Raw address of the object being built , fields are written in place
+  // through it
+  void* address() const { return address_; }
 
   // Release the object back to the user
-  template< typename T > std::unique_ptr<T> Get() { 
-    auto holder = Release();
-    T* ptr;
-    try {
-      ptr = std::any_cast<T*>(holder);
-    } catch(...) {
+  template< typename T > std::unique_ptr<T> Get() {
+    auto ref = Release();
+    auto ptr = ref.As<T>();
+    if(!ptr && ref.ptr) {
       Fatal("You are trying to get object as type %s, but actual registered "
-            "type information is %s",typeid(T).name(),holder.type().name());
+            "type information is %s",typeid(T).name(),klass()->name());
     }
     return std::unique_ptr<T>(ptr);
   }
 
-  // Get the value as std::any wrapped value , user to recursively build
-  // needed object in a type safe way
-  std::any GetAny() { return Release(); }
+  // Get the object as a typed pointer , user to recursively build needed
+  // object in a type safe way
+  ObjectRef GetRef() { return Release(); }
+
+  // The object as a typed pointer which is still owned by the builder , it
+  // is destroyed with the builder unless GetRef releases it
+  ObjectRef PeekRef() const { return ObjectRef(address_,klass_->type_id()); }
+
+  // Release the object into a shared pointer , only an object allocated
+  // on heap can be shared
+  SharedRef GetShared() { return ReleaseShared(); }
 
  protected:
-  // Use std::any for type safe purpose
-  virtual std::any Release() { assert(false); return std::any(); }
+  // Write the field attribute directly into the object , without going
+  // through the virtual setter of the attribute
+  template< typename V > bool WriteField( const Attribute* attr , V&& value );
+
+  // TypeId tagged pointer for type safe purpose
+  virtual ObjectRef Release() { assert(false); return ObjectRef(); }
+
+  virtual SharedRef ReleaseShared() {
+    Fatal("object %s is not allocated on heap and cannot be shared",
+          klass_->name());
+    return SharedRef();
+  }
 
  private:
-  std::shared_ptr<Klass> klass_;
+  // Klass object lives as long as the process , so no reference is held
+  Klass* klass_;
+
+  void* address_;
+};
+
+// Inline storage for a KlassBuilder. All builders have the same small size
+// so they can be placed on the stack of the caller instead of the heap ,
+// the builder is destroyed with the storage
+class BuilderStorage {
+ public:
+  static const std::size_t kSize = 4 * sizeof(void*);
+
+  BuilderStorage() : builder_(NULL) {}
+  ~BuilderStorage() { Reset(); }
+
+  template< typename B , typename... ARGS > B* Emplace( ARGS&&... args ) {
+    static_assert(sizeof(B) <= kSize && alignof(B) <= alignof(void*),
+                  "KlassBuilder is too large to fit into BuilderStorage");
+    Reset();
+    auto builder = ::new (buffer_) B(std::forward<ARGS>(args)...);
+    builder_ = builder;
+    return builder;
+  }
+
+  KlassBuilder* get() const { return builder_; }
+
+  void Reset() {
+    if(builder_) {
+      builder_->~KlassBuilder();
+      builder_ = NULL;
+    }
+  }
+
+ private:
+  alignas(void*) char buffer_[kSize];
+  KlassBuilder* builder_;
+
+  BuilderStorage( const BuilderStorage& ) = delete;
+  BuilderStorage& operator = ( const BuilderStorage& ) = delete;
 };
 
 class Attribute {
  public:
-  Attribute( const char* name  , CppType type , const char* dep ):
+  Attribute( const char* name  , CppType type , const char* dep ,
+             std::ptrdiff_t offset = -1 ):
     name_(name),
     dep_ (dep) ,
-    type_(type)
+    type_(type),
+    hash_(HashName(name)),
+    symbol_(Intern(name)),
+    dep_symbol_(dep ? Intern(dep) : kNoSymbol),
+    offset_(offset)
   {}
 
   const char* name() const { return name_; }
+  std::uint32_t hash() const { return hash_; }
+  Symbol    symbol() const { return symbol_; }
+  Symbol dep_symbol() const { return dep_symbol_; }
   const char* dep () const { return dep_ ; }
   CppType     type() const { return type_; }
   inline const char* type_name() const;
 
+  // A field attribute is a data member written directly at offset of the
+  // object , no setter is invoked
+  bool is_field() const { return offset_ >= 0; }
+
+  // Whether the object attribute setter takes a std::shared_ptr
+  virtual bool is_shared() const { return false; }
+  std::ptrdiff_t offset() const { return offset_; }
+
   virtual ~Attribute() {}
 
  private:
   const char* name_; // name of attribute
   const char* dep_ ; // if it is an object, the specific type name
   CppType type_;     // type of attribute
+  std::uint32_t hash_; // hash of the name
+  Symbol symbol_;      // interned name
+  Symbol dep_symbol_;  // interned dep , kNoSymbol if no dep
+  std::ptrdiff_t offset_; // offset of field , -1 if not a field
 };
 
 template< typename OBJ >
 struct ObjectAttributeSetter : public Attribute {
   typedef OBJ ObjectType;
 
-  virtual void Set( OBJ* , Value&& , const Klass* ) = 0;
+  // Returns false if the value doesn't match the type of the attribute ,
+  // the setter is not invoked then
+  virtual bool Set( OBJ* , Value&& , const Klass* ) = 0;
 
-  ObjectAttributeSetter( const char* n , CppType type , const char* dep ):
-    Attribute(n,type,dep) {}
+  // Set without consuming the value , used when the same value is applied
+  // to lots of objects
+  virtual bool Set( OBJ* , const Value& , const Klass* ) = 0;
+
+  ObjectAttributeSetter( const char* n , CppType type , const char* dep ,
+                         std::ptrdiff_t offset = -1 ):
+    Attribute(n,type,dep,offset) {}
 };
 
 template< typename OBJ >
 struct ObjectAttributeGetter : public Attribute {
   typedef OBJ ObjectType;
 
-  virtual std::unique_ptr<KlassBuilder> Get( OBJ* , const char* ) = 0;
+  virtual KlassBuilder* Get( OBJ* , BuilderStorage* ) = 0;
 
   ObjectAttributeGetter( const char* n , CppType type , const char* dep ):
     Attribute(n,type,dep) {}
@@ -217,18 +579,18 @@ struct PrimitiveImpl : public ObjectAttributeSetter<OBJ> {};
   struct PrimitiveImpl<OBJ,X> : public ObjectAttributeSetter<OBJ> {\
     typedef void (OBJ::*Func)( X );                                \
     typedef ObjectAttributeSetter<OBJ> Base;                       \
-    virtual void Set(OBJ* object,Value&& value,                    \
+    virtual bool Set(OBJ* object,Value&& value,                    \
         const Klass* klass) {                                      \
+      return Set(object,static_cast<const Value&>(value),klass);   \
+    }                                                              \
+    virtual bool Set(OBJ* object,const Value& value,               \
+        const Klass* ) {                                           \
       typedef typename MapPrimitiveCppTypeToUniversalType<X>::type \
         FromType;                                                  \
-      FromType v;                                                  \
-      try {                                                        \
-        v = std::get<FromType>(value);                             \
-      } catch(...) {                                               \
-        Fatal("object %s's attribute %s expect type %s\n",         \
-            klass->name(),Base::name(),Base::type_name());         \
-      }                                                            \
+      FromType v = FromType();                                     \
+      if(!GetPrimitive(value,&v)) return false;                    \
       (object->*func)(static_cast<X>(v));                          \
+      return true;                                                 \
     }                                                              \
     PrimitiveImpl( const char* name , Func f ):                    \
       Base(name,MapPrimitiveCppTypeToEnum<X>::value,NULL),func(f)  \
@@ -248,22 +610,26 @@ struct StringImpl : public ObjectAttributeSetter<OBJ> {
   typedef void (OBJ::*CRSetter)( const std::string& );
   typedef void (OBJ::*MVSetter)( std::string&&      );
 
-  virtual void Set( OBJ* object , Value&& value , const Klass* klass ) {
-
-    try {
-      std::string& v = std::get<std::string>(value);
-      (void)v;
-    } catch(...) {
-      Fatal("object %s's attribute %s expect type %s",
-          klass->name(),Base::name(),Base::type_name());
+  virtual bool Set( OBJ* object , Value&& value , const Klass* ) {
+    auto v = std::get_if<std::string>(&value);
+    if(!v) return false;
+    if(cr_setter) {
+      (object->*cr_setter)(*v);
+    } else {
+      (object->*mv_setter)(std::move(*v));
     }
+    return true;
+  }
 
-    std::string& v = std::get<std::string>(value);
+  virtual bool Set( OBJ* object , const Value& value , const Klass* ) {
+    auto v = std::get_if<std::string>(&value);
+    if(!v) return false;
     if(cr_setter) {
-      (object->*cr_setter)(v);
+      (object->*cr_setter)(*v);
     } else {
-      (object->*mv_setter)(std::move(v));
+      (object->*mv_setter)(std::string(*v));
     }
+    return true;
   }
 
   CRSetter cr_setter;
@@ -289,7 +655,7 @@ struct StructImpl : public ObjectAttributeGetter<OBJ> {
   typedef ObjectAttributeGetter<OBJ> Base;
   typedef T* (OBJ::*Getter)();
 
-  virtual std::unique_ptr<KlassBuilder> Get( OBJ* , const char* name );
+  virtual KlassBuilder* Get( OBJ* , BuilderStorage* );
 
   StructImpl( const char* name , const char* dep , Getter g ):
     Base(name,kTypeStruct,dep),
@@ -307,18 +673,16 @@ struct ObjectImpl : public ObjectAttributeSetter<OBJ> {
   typedef ObjectAttributeSetter<OBJ> Base;
   typedef void (OBJ::*Func)( T* );
 
-  virtual void Set( OBJ* object, Value&& value , const Klass* klass ) {
-    std::any holder;
-
-    try {
-      holder = std::get<std::any>(value);  // type safe
-    } catch(...) {
-      Fatal("object %s's attribute %s except type %s",
-          klass->name() , Base::name() , Base::type_name() );
-    }
+  virtual bool Set( OBJ* object, Value&& value , const Klass* klass ) {
+    return Set(object,static_cast<const Value&>(value),klass);
+  }
 
-    auto raw = std::any_cast<T*> (holder); // type safe
+  virtual bool Set( OBJ* object, const Value& value , const Klass* ) {
+    auto ref = std::get_if<ObjectRef>(&value);
+    auto raw = ref ? ref->As<T>() : NULL;   // type safe
+    if(!raw) return false;
     (object->*func)(raw);
+    return true;
   }
 
   ObjectImpl( const char* name , const char* dep , Func f ):
@@ -328,19 +692,107 @@ struct ObjectImpl : public ObjectAttributeSetter<OBJ> {
   Func func;
 };
 
+// Object attribute whose setter takes a std::shared_ptr , the object is
+// either a shared instance resolved by reference or a new object built from
+// the nested config which is then owned by the shared_ptr
+template<typename OBJ,typename T>
+struct SharedImpl : public ObjectAttributeSetter<OBJ> {
+  static_assert(std::is_class<T>::value,
+                "require an object pointer here to be delcared as shared type");
+
+  typedef ObjectAttributeSetter<OBJ> Base;
+  typedef void (OBJ::*Func)( std::shared_ptr<T> );
+
+  virtual bool Set( OBJ* object, Value&& value , const Klass* klass ) {
+    return Set(object,static_cast<const Value&>(value),klass);
+  }
+
+  virtual bool Set( OBJ* object, const Value& value , const Klass* ) {
+    std::shared_ptr<T> ptr;
+    if(auto shared = std::get_if<SharedRef>(&value)) {
+      ptr = shared->As<T>();
+    } else if(auto ref = std::get_if<ObjectRef>(&value)) {
+      ptr.reset(ref->As<T>());
+    }
+    if(!ptr) return false;
+    (object->*func)(std::move(ptr));
+    return true;
+  }
+
+  virtual bool is_shared() const { return true; }
+
+  SharedImpl( const char* name , const char* dep , Func f ):
+    Base(name,kTypeObject,dep), func(f)
+  {}
+
+  Func func;
+};
+
+template< typename OBJ >
+struct FieldImpl : public ObjectAttributeSetter<OBJ> {
+  typedef ObjectAttributeSetter<OBJ> Base;
+
+  virtual bool Set( OBJ* object , Value&& value , const Klass* ) {
+    return StoreField(Address(object),Base::type(),std::move(value));
+  }
+
+  virtual bool Set( OBJ* object , const Value& value , const Klass* ) {
+    return StoreField(Address(object),Base::type(),value);
+  }
+
+  FieldImpl( const char* name , CppType type , std::ptrdiff_t offset ):
+    Base(name,type,NULL,offset)
+  {}
+
+ private:
+  void* Address( OBJ* object ) const {
+    return reinterpret_cast<char*>(object) + Base::offset();
+  }
+};
+
+// Class and type of a data member pointer
+template< typename M > struct FieldTraits {};
+
+template< typename C , typename X > struct FieldTraits<X C::*> {
+  typedef C ClassType;
+  typedef X FieldType;
+};
+
+template< typename X > struct MapFieldTypeToEnum :
+  public MapPrimitiveCppTypeToEnum<X> {};
+
+template<> struct MapFieldTypeToEnum<std::string> {
+  static const CppType value = kTypeString;
+};
+
+// Offset of the data member inside of T , the member is only addressed and
+// never accessed
+template< typename T , auto MEMBER > std::ptrdiff_t FieldOffset() {
+  alignas(T) static char kBuffer[sizeof(T)];
+  auto object = reinterpret_cast<T*>(kBuffer);
+  return reinterpret_cast<char*>(&(object->*MEMBER)) - kBuffer;
+}
+
 template< typename T >
 struct HeapKlassBuilderImpl : public KlassBuilder {
   typedef T ObjectType;
-  HeapKlassBuilderImpl( const std::shared_ptr<Klass>& klass ) :
-    KlassBuilder(klass) , object_( new T() )
+  HeapKlassBuilderImpl( Klass* klass ) :
+    KlassBuilder(klass,new T()) , object_( static_cast<T*>(address()) )
   {}
 
-  virtual void Build( const char* , Value&& value );
-  virtual void Build( Attribute*  , Value&& value );
-  virtual std::unique_ptr<KlassBuilder> BuildStruct( Attribute* );
+  virtual bool Build( const char* , Value&& value );
+  virtual bool Build( Attribute*  , Value&& value );
+  virtual bool Build( Attribute*  , const Value& value );
+  virtual KlassBuilder* BuildStruct( Attribute* , BuilderStorage* );
 
-  virtual std::any Release()
-  { assert(object_); return std::any(object_.release()); }
+  virtual ObjectRef Release()
+  { assert(object_); return ObjectRef::Of(object_.release()); }
+
+  virtual SharedRef ReleaseShared() {
+    assert(object_);
+    return SharedRef(std::shared_ptr<T>(object_.release()),
+                     KlassTypeId<T>::value);
+  }
 
  private:
   std::unique_ptr<T> object_;
@@ -350,26 +802,43 @@ template< typename T >
 struct StructKlassBuilderImpl : public KlassBuilder {
   typedef T ObjectType;
 
-  StructKlassBuilderImpl( const std::shared_ptr<Klass>& klass ,
-      T* object ):
-    KlassBuilder(klass) , object_(object)
+  StructKlassBuilderImpl( Klass* klass , T* object ):
+    KlassBuilder(klass,object)
   {}
 
+  virtual bool Build( const char* , Value&& value );
+  virtual bool Build( Attribute*  , Value&& value );
+  virtual bool Build( Attribute*  , const Value& value );
+  virtual KlassBuilder* BuildStruct( Attribute* , BuilderStorage* );
+
+ protected:
+  T* object() const { return static_cast<T*>(address()); }
+};
 
-  virtual void Build( const char* , Value&& value );
-  virtual void Build( Attribute*  , Value&& value );
-  virtual std::unique_ptr<KlassBuilder> BuildStruct( Attribute* );
+template< typename T >
+struct ArenaKlassBuilderImpl : public StructKlassBuilderImpl<T> {
+  ArenaKlassBuilderImpl( Klass* klass , Arena* arena ):
+    StructKlassBuilderImpl<T>(klass,arena->New<T>())
+  {}
 
- private:
-  T* object_;
+  // The object is owned by the arena , the released pointer must not
+  // be deleted
+  virtual ObjectRef Release() { return ObjectRef::Of(this->object()); }
 };
 
 template< typename T >
 class KlassImpl : public Klass {
  public:
   virtual std::unique_ptr<KlassBuilder> New() {
-    return std::unique_ptr<KlassBuilder>(
-        new HeapKlassBuilderImpl<T>(shared_from_this()) );
+    return std::unique_ptr<KlassBuilder>( new HeapKlassBuilderImpl<T>(this) );
+  }
+
+  virtual KlassBuilder* New( BuilderStorage* storage ) {
+    return storage->Emplace<HeapKlassBuilderImpl<T>>(this);
+  }
+
+  virtual KlassBuilder* New( Arena* arena , BuilderStorage* storage ) {
+    return storage->Emplace<ArenaKlassBuilderImpl<T>>(this,arena);
   }
 
   KlassImpl& Inherit ( const char* );
@@ -399,38 +868,116 @@ class KlassImpl : public Klass {
     return AddAttribute( new ObjectImpl<T,PTYPE>(name,dep,setter) );
   }
 
-  KlassImpl( const char* name ) : Klass(name) {}
+  // Same as AddObject but the setter takes a std::shared_ptr , the config
+  // value can be a reference to a named instance of a Container , see
+  // container.h. The object built from a nested config is always created
+  // on heap , even by the arena New
+  template< typename PTYPE >
+  KlassImpl& AddShared   ( const char* name , const char* dep ,
+                           void (T::*setter)(std::shared_ptr<PTYPE>) ) {
+    return AddAttribute( new SharedImpl<T,PTYPE>(name,dep,setter) );
+  }
+
+  // Register a primitive or string data member as attribute , e.g.
+  // AddField<&T::hp>("hp"). The value is written directly into the member
+  // instead of through a setter
+  template< auto MEMBER >
+  KlassImpl& AddField  ( const char* name ) {
+    typedef FieldTraits<decltype(MEMBER)> Traits;
+    static_assert(std::is_base_of<typename Traits::ClassType,T>::value,
+                  "field must be a data member of the class");
+    return AddAttribute( new FieldImpl<T>(name,
+          MapFieldTypeToEnum<typename Traits::FieldType>::value,
+          FieldOffset<T,MEMBER>()) );
+  }
+
+  // Objects built from identical nested configs are copied with the copy
+  // constructor from a memoized one when built with a MemoCache
+  KlassImpl& Memoize() {
+    static_assert(std::is_copy_constructible<T>::value,
+                  "memoized class must be copy constructible");
+    clone_ = &CloneObject;
+    destroy_ = &DestroyObject;
+    object_size_ = sizeof(T);
+    return *this;
+  }
+
+  // Objects are not modified after being built , with a MemoCache identical
+  // nested configs of an AddShared attribute share one object
+  KlassImpl& Immutable() {
+    immutable_ = true;
+    object_size_ = sizeof(T);
+    return *this;
+  }
+
+  KlassImpl( const char* name ) : Klass(name,GetTypeId<T>()) {}
 
  private:
+  static void* CloneObject( const void* object ) {
+    return new T(*static_cast<const T*>(object));
+  }
+
+  static void DestroyObject( void* object ) {
+    delete static_cast<T*>(object);
+  }
+
   KlassImpl& AddAttribute( Attribute* );
 };
 
 
 // Find the global class object
 Klass* GetKlass( const char* );
+Klass* GetKlass( Symbol );
 
 // Add a Klass object with its class name
 void   AddKlass( const char* , const std::shared_ptr<Klass>& );
 
+// Seal every Klass and turn the registry into an immutable table , after
+// that registration is a fatal error and the registry can be used by any
+// thread concurrently
+void FreezeKlass();
+
+// Whether FreezeKlass has been called
+bool IsFrozen();
+
 // Create a KlassBuilder based on the name
 std::unique_ptr<KlassBuilder> NewKlassObject  ( const char* );
+std::unique_ptr<KlassBuilder> NewKlassObject  ( Symbol );
+
+// Create a KlassBuilder inside of the storage , returns NULL if not found
+KlassBuilder* NewKlassObject( Symbol , BuilderStorage* );
+
+// Create a KlassBuilder inside of the storage whose object is placed in
+// the arena , returns NULL if not found
+KlassBuilder* NewKlassObject( Symbol , Arena* , BuilderStorage* );
 
 template< typename OBJ , typename T >
-std::unique_ptr<KlassBuilder> StructImpl<OBJ,T>::Get( OBJ* obj ,
-                                                      const char* name ) {
+KlassBuilder* StructImpl<OBJ,T>::Get( OBJ* obj , BuilderStorage* storage ) {
   auto ret = (obj->*getter)();
-  auto klass = GetKlass(name);
-  return std::unique_ptr<KlassBuilder>(
-      new StructKlassBuilderImpl<T>(klass->shared_from_this(),ret));
+  auto klass = GetKlass(Base::dep_symbol());
+  return storage->Emplace<StructKlassBuilderImpl<T>>(klass,ret);
+}
+
+template< typename V >
+bool KlassBuilder::WriteField( const Attribute* attr , V&& value ) {
+  auto address = static_cast<char*>(address_) + attr->offset();
+  return StoreField(address,attr->type(),std::forward<V>(value));
 }
 
 inline const char* Attribute::type_name() const {
-  if(type() != kTypeObject)
+  if(type() != kTypeObject && type() != kTypeStruct)
     return GetCppTypeName(type());
   else
     return dep();
 }
 
+// Abort on a value which doesn't match the type of the attribute , used by
+// the build paths which have no way to report an error
+inline void TypeMismatch( const Klass* klass , const Attribute* attr ) {
+  Fatal("object %s's attribute %s expect type %s",
+      klass->name(),attr->name(),attr->type_name());
+}
+
 // New a Klass object
 template< typename T > KlassImpl<T>& NewKlass( const char* name ) {
   auto impl = std::make_shared<KlassImpl<T>>(name);
@@ -439,49 +986,83 @@ template< typename T > KlassImpl<T>& NewKlass( const char* name ) {
 }
 
 template< typename T >
-void HeapKlassBuilderImpl<T>::Build( Attribute* attr , Value&& value ) {
+bool HeapKlassBuilderImpl<T>::Build( Attribute* attr , Value&& value ) {
+  DINJECT_PROFILE_COUNT(klass(),setter_count);
+  DINJECT_PROFILE_TIME(klass(),setter_ns);
+  DINJECT_TRACE_SPAN(Setter,attr->symbol());
   assert( attr->type() != kTypeStruct ); // struct is handled specifically
+  if(attr->is_field()) {
+    return WriteField(attr,std::move(value));
+  }
   auto oattr = static_cast<ObjectAttributeSetter<T>*>(attr);
-  oattr->Set(object_.get(),std::move(value),klass());
+  return oattr->Set(object_.get(),std::move(value),klass());
 }
 
 template< typename T >
-void HeapKlassBuilderImpl<T>::Build( const char* name , Value&& value ) {
-  auto attr = FindAttribute(name);
-  if(attr) {
-    Build(attr,std::move(value));
+bool HeapKlassBuilderImpl<T>::Build( Attribute* attr , const Value& value ) {
+  DINJECT_PROFILE_COUNT(klass(),setter_count);
+  DINJECT_PROFILE_TIME(klass(),setter_ns);
+  DINJECT_TRACE_SPAN(Setter,attr->symbol());
+  assert( attr->type() != kTypeStruct );
+  if(attr->is_field()) {
+    return WriteField(attr,value);
   }
+  auto oattr = static_cast<ObjectAttributeSetter<T>*>(attr);
+  return oattr->Set(object_.get(),value,klass());
 }
 
 template< typename T >
-std::unique_ptr<KlassBuilder>
-HeapKlassBuilderImpl<T>::BuildStruct( Attribute* attr ) {
+bool HeapKlassBuilderImpl<T>::Build( const char* name , Value&& value ) {
+  auto attr = FindAttribute(name);
+  return attr ? Build(attr,std::move(value)) : true;
+}
+
+template< typename T >
+KlassBuilder* HeapKlassBuilderImpl<T>::BuildStruct( Attribute* attr ,
+                                                    BuilderStorage* storage ) {
   assert(attr->type() == kTypeStruct );
   auto oattr = static_cast<ObjectAttributeGetter<T>*>(attr);
-  return oattr->Get(object_.get(),attr->dep());
+  return oattr->Get(object_.get(),storage);
 }
 
 template< typename T >
-void StructKlassBuilderImpl<T>::Build( Attribute* attr , Value&& value ) {
+bool StructKlassBuilderImpl<T>::Build( Attribute* attr , Value&& value ) {
+  DINJECT_PROFILE_COUNT(klass(),setter_count);
+  DINJECT_PROFILE_TIME(klass(),setter_ns);
+  DINJECT_TRACE_SPAN(Setter,attr->symbol());
+  assert( attr->type() != kTypeStruct ); // struct is handled specifically
+  if(attr->is_field()) {
+    return WriteField(attr,std::move(value));
+  }
+  auto oattr = static_cast<ObjectAttributeSetter<T>*>(attr);
+  return oattr->Set(object(),std::move(value),klass());
+}
+
+template< typename T >
+bool StructKlassBuilderImpl<T>::Build( Attribute* attr , const Value& value ) {
+  DINJECT_PROFILE_COUNT(klass(),setter_count);
+  DINJECT_PROFILE_TIME(klass(),setter_ns);
+  DINJECT_TRACE_SPAN(Setter,attr->symbol());
   assert( attr->type() != kTypeStruct );
+  if(attr->is_field()) {
+    return WriteField(attr,value);
+  }
   auto oattr = static_cast<ObjectAttributeSetter<T>*>(attr);
-  oattr->Set(object_,std::move(value),klass());
+  return oattr->Set(object(),value,klass());
 }
 
 template< typename T >
-void StructKlassBuilderImpl<T>::Build( const char* name , Value&& value ) {
+bool StructKlassBuilderImpl<T>::Build( const char* name , Value&& value ) {
   auto attr = FindAttribute(name);
-  if(attr) {
-    Build(attr,std::move(value));
-  }
+  return attr ? Build(attr,std::move(value)) : true;
 }
 
 template< typename T >
-std::unique_ptr<KlassBuilder>
-StructKlassBuilderImpl<T>::BuildStruct( Attribute* attr ) {
+KlassBuilder* StructKlassBuilderImpl<T>::BuildStruct( Attribute* attr ,
+                                                      BuilderStorage* storage ) {
   assert(attr->type() == kTypeStruct );
   auto oattr = static_cast<ObjectAttributeGetter<T>*>(attr);
-  return oattr->Get(object_,attr->dep());
+  return oattr->Get(object(),storage);
 }
 
 template< typename T >
@@ -494,6 +1075,7 @@ KlassImpl<T>& KlassImpl<T>::Inherit ( const char* name ) {
     }
 #endif // NDEBUG
     parents_.push_back(klass->shared_from_this());
+    InvalidateKlassTable();
   }
   return *this;
 }
@@ -506,6 +1088,7 @@ KlassImpl<T>& KlassImpl<T>::AddAttribute( Attribute* attribute ) {
   }
 #endif // NDEBUG
   attributes_.emplace_back(attribute);
+  InvalidateKlassTable();
   return *this;
 }
 
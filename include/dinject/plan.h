@@ -0,0 +1,171 @@
+#ifndef DINJECT_PLAN_H_
+#define DINJECT_PLAN_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include "dinject.h"
+
+namespace dinject {
+
+/**
+ * A Plan is a ConfigObject which has been resolved against a Klass once.
+ *
+ * All attribute lookup , sub object/struct resolving and value conversion
+ * are done when the Plan is created and the result is stored as a flat
+ * instruction list. Creating an object from a Plan only replays the setters,
+ * which is much cheaper than New<T> when lots of objects are spawned from
+ * the same config.
+ *
+ * The Plan doesn't keep reference to the ConfigObject, so modification of the
+ * config after the Plan is created is not reflected.
+ *
+ * Primitive fields registered with AddField are encoded as raw bytes and
+ * copied into the object before the setters of the same object run, adjacent
+ * fields are copied with one memcpy.
+ */
+class Plan {
+ public:
+  Plan( const char* name , const ConfigObject& config );
+
+  // Whether the class is found , New of an invalid Plan returns null
+  bool valid() const { return klass_ != NULL; }
+
+  // Name of the class this Plan creates
+  const char* name() const { return klass_ ? klass_->name() : NULL; }
+
+  // TypeId of the class this Plan creates
+  detail::TypeId klass_type() const {
+    return klass_ ? klass_->type_id() : detail::kNoTypeId;
+  }
+
+  // Number of instructions in this Plan
+  std::size_t size() const { return code_.size(); }
+
+  // Create an object of type T by replaying the Plan
+  template< typename T > std::unique_ptr<T> New() const;
+
+  // Replay the Plan on an already constructed object , returns false if the
+  // Plan is invalid or is not compiled for class T
+  template< typename T > bool Apply( T* object ) const;
+
+  // Replay the Plan on a builder , the builder must be created from the
+  // Klass this Plan is compiled against
+  void Replay( detail::KlassBuilder* builder ) const;
+
+ private:
+  enum OpCode {
+    kOpBuild,        // set a primitive/string attribute with value
+    kOpField,        // copy bytes of primitive fields into the object
+    kOpBeginObject,  // create a nested object of klass
+    kOpEndObject,    // set the nested object to attribute of parent
+    kOpBeginStruct,  // start to build the struct attribute
+    kOpEndStruct     // end of struct attribute
+  };
+
+  struct Instruction {
+    OpCode op;
+    detail::Attribute* attr;
+    detail::Klass* klass;
+    detail::Value value;
+
+    // kOpField copies size bytes from data_ at data to offset of the object,
+    // adjacent fields are merged into one instruction
+    std::size_t offset;
+    std::size_t size;
+    std::size_t data;
+
+    Instruction( OpCode o , detail::Attribute* a , detail::Klass* k ):
+      op(o), attr(a), klass(k), value(), offset(), size(), data()
+    {}
+  };
+
+  class Compiler;
+
+  void Compile( const detail::Klass* klass , const ConfigObject& config );
+
+  // Encoded value of a primitive field
+  struct Field {
+    std::size_t offset;
+    std::size_t size;
+    std::uint64_t bits;
+  };
+
+  // Encode a primitive field value , returns false if the attribute is not
+  // a primitive field
+  static bool CompileField( const detail::Klass* klass ,
+                            const detail::Attribute* attr ,
+                            const detail::Value& value , Field* output );
+
+  // Emit fields of one object at pc as kOpField instructions , fields are
+  // sorted by offset and adjacent ones are merged into one copy
+  void EmitField( std::size_t pc , std::vector<Field>* fields );
+
+  // Replay from pc until the end of current object/struct , returns the
+  // position of the matching end instruction
+  std::size_t Replay( detail::KlassBuilder* builder , std::size_t pc ) const;
+
+  detail::Klass* klass_;
+  std::vector<Instruction> code_;
+  std::vector<unsigned char> data_;
+};
+
+template< typename T > std::unique_ptr<T> Plan::New() const {
+  if(!klass_) return std::unique_ptr<T>();
+  detail::BuilderStorage storage;
+  auto kb = klass_->New(&storage);
+  Replay(kb);
+  return kb->template Get<T>();
+}
+
+template< typename T > bool Plan::Apply( T* object ) const {
+  if(!klass_ || klass_->type_id() != detail::KlassTypeId<T>::value)
+    return false;
+  detail::BuilderStorage storage;
+  auto kb = storage.Emplace<detail::StructKlassBuilderImpl<T>>(klass_,object);
+  Replay(kb);
+  return true;
+}
+
+// Create count objects of class name from the same config. The class lookup,
+// attribute resolving and value conversion are done once , each instance only
+// replays the setters with values that are shared by all of them
+template< typename T >
+std::vector<std::unique_ptr<T>> NewBatch( const char* name ,
+                                          const ConfigObject& config ,
+                                          std::size_t count ) {
+  std::vector<std::unique_ptr<T>> result;
+  Plan plan(name,config);
+  if(!plan.valid() || plan.klass_type() != detail::KlassTypeId<T>::value)
+    return result;
+  result.reserve(count);
+  for( std::size_t i = 0 ; i < count ; ++i ) {
+    std::unique_ptr<T> object(new T());
+    plan.Apply(object.get());
+    result.push_back(std::move(object));
+  }
+  return result;
+}
+
+// Construct count objects in place into caller supplied storage , which must
+// be uninitialized memory for at least count T. Returns number of objects
+// constructed , which is either count or 0 when the class is not found or is
+// not of type T. Caller is responsible for destructing the objects
+template< typename T >
+std::size_t NewBatch( const char* name , const ConfigObject& config ,
+                      T* storage , std::size_t count ) {
+  Plan plan(name,config);
+  if(!plan.valid() || plan.klass_type() != detail::KlassTypeId<T>::value)
+    return 0;
+  for( std::size_t i = 0 ; i < count ; ++i ) {
+    plan.Apply(new (storage + i) T());
+  }
+  return count;
+}
+
+} // namespace dinject
+
+#endif // DINJECT_PLAN_H_
@@ -0,0 +1,153 @@
+#ifndef DINJECT_PROFILE_H_
+#define DINJECT_PROFILE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#ifdef DINJECT_PROFILE
+#include <atomic>
+#include <chrono>
+#endif // DINJECT_PROFILE
+
+#include "symbol.h"
+
+namespace dinject {
+
+/**
+ * Injection profiling , compiled in only when DINJECT_PROFILE is defined.
+ *
+ * The library and every translation unit including dinject must be built
+ * with the same setting , e.g. make PROFILE=1. When it is not defined the
+ * instrumentation macros expand to nothing and the query functions below
+ * return no data.
+ *
+ * For each class it records the number of objects created and the time
+ * spent in allocation , attribute lookup , setters and the whole build ,
+ * plus failed attribute lookups , which are config keys silently ignored.
+ * The build time of an object includes its nested objects.
+ *
+ * Every timed operation reads the steady clock twice , so a profiled build
+ * is several times slower. Use the numbers to compare classes with each
+ * other rather than as absolute cost.
+ */
+
+// Build latency histogram , bucket i counts builds in [2^i,2^(i+1)) ns
+static const std::size_t kProfileBuckets = 32;
+
+struct KlassProfile {
+  std::string   name;
+  std::uint64_t count;        // objects created
+  std::uint64_t build_ns;     // building objects , nested objects included
+  std::uint64_t alloc_ns;     // allocating and constructing objects
+  std::uint64_t lookup_ns;    // resolving attributes by name or symbol
+  std::uint64_t setter_ns;    // invoking setters and writing fields
+  std::uint64_t setter_count;
+  std::uint64_t miss;         // failed attribute lookups
+  std::uint64_t histogram[kProfileBuckets];
+
+  // Approximate build latency in ns at quantile q in [0,1] , it is the
+  // upper bound of the histogram bucket
+  std::uint64_t Percentile( double q ) const;
+};
+
+// Whether the library is compiled with DINJECT_PROFILE
+bool ProfileEnabled();
+
+// Profile of every class which has been used , ordered by build time
+std::vector<KlassProfile> GetProfile();
+
+// Profile of one class , returns false if it has not been used
+bool GetProfile( const char* klass , KlassProfile* output );
+
+// Clear all the counters
+void ResetProfile();
+
+// Print the profile as a table
+void DumpProfile( std::FILE* output = stderr );
+
+namespace detail {
+
+#ifdef DINJECT_PROFILE
+
+struct KlassStats {
+  std::atomic<std::uint64_t> count;
+  std::atomic<std::uint64_t> build_ns;
+  std::atomic<std::uint64_t> alloc_ns;
+  std::atomic<std::uint64_t> lookup_ns;
+  std::atomic<std::uint64_t> setter_ns;
+  std::atomic<std::uint64_t> setter_count;
+  std::atomic<std::uint64_t> miss;
+  std::atomic<std::uint64_t> histogram[kProfileBuckets];
+};
+
+// Counters of the class , indexed by its Symbol
+KlassStats* GetKlassStats( Symbol klass );
+
+inline std::uint64_t ProfileNow() {
+  return static_cast<std::uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Add the time of its scope to a counter
+class ProfileTimer {
+ public:
+  explicit ProfileTimer( std::atomic<std::uint64_t>* total ):
+    total_(total), start_(ProfileNow())
+  {}
+
+  ~ProfileTimer() {
+    total_->fetch_add(ProfileNow() - start_,std::memory_order_relaxed);
+  }
+
+ private:
+  std::atomic<std::uint64_t>* total_;
+  std::uint64_t start_;
+};
+
+// Add the time of its scope to the build time and the histogram
+class BuildTimer {
+ public:
+  explicit BuildTimer( Symbol klass ):
+    stats_(GetKlassStats(klass)), start_(ProfileNow())
+  {}
+
+  ~BuildTimer() {
+    auto ns = ProfileNow() - start_;
+    std::size_t bucket = 0;
+    while(bucket + 1 < kProfileBuckets && (ns >> (bucket + 1))) ++bucket;
+    stats_->build_ns.fetch_add(ns,std::memory_order_relaxed);
+    stats_->histogram[bucket].fetch_add(1,std::memory_order_relaxed);
+  }
+
+ private:
+  KlassStats* stats_;
+  std::uint64_t start_;
+};
+
+#define DINJECT_PROFILE_COUNT(KLASS,FIELD)                                   \
+  ::dinject::detail::GetKlassStats((KLASS)->symbol())->FIELD.fetch_add(     \
+      1,std::memory_order_relaxed)
+
+#define DINJECT_PROFILE_TIME(KLASS,FIELD)                                    \
+  ::dinject::detail::ProfileTimer _dinject_profile_##FIELD(                 \
+      &::dinject::detail::GetKlassStats((KLASS)->symbol())->FIELD)
+
+#define DINJECT_PROFILE_BUILD(KLASS)                                         \
+  ::dinject::detail::BuildTimer _dinject_profile_build((KLASS)->symbol())
+
+#else
+
+#define DINJECT_PROFILE_COUNT(KLASS,FIELD) ((void)0)
+#define DINJECT_PROFILE_TIME(KLASS,FIELD)  ((void)0)
+#define DINJECT_PROFILE_BUILD(KLASS)       ((void)0)
+
+#endif // DINJECT_PROFILE
+
+} // namespace detail
+} // namespace dinject
+
+#endif // DINJECT_PROFILE_H_
@@ -0,0 +1,124 @@
+#ifndef DINJECT_PROTOTYPE_H_
+#define DINJECT_PROTOTYPE_H_
+
+#include <functional>
+#include <memory>
+#include <type_traits>
+
+#include "dinject.h"
+
+namespace dinject {
+
+/**
+ * A prototype is an object which is built once from a config through the
+ * normal injection path and registered by name. Clone creates new instances
+ * by copying the prototype , the config and the attribute setters are not
+ * touched again.
+ *
+ * By default the prototype is copied with the copy constructor of T , a
+ * class which is not copyable (or needs deep copy of its owned objects) can
+ * supply its own clone function.
+ *
+ * Like Class , prototypes must be registered before any worker thread starts.
+ * Clone itself only reads the registry and is safe to call concurrently.
+ */
+
+namespace detail {
+
+struct Prototype {
+  Klass* klass;
+  ObjectRef object;
+  std::function<void* (const void*)> clone;
+  void (*destroy)( void* );
+
+  Prototype() : klass(NULL), object(), clone(), destroy(NULL) {}
+  ~Prototype() { if(destroy) destroy(object.ptr); }
+};
+
+// Take the ownership of prototype and register it under name , the old one
+// with the same name is destroyed
+void AddPrototype( const char* name , std::unique_ptr<Prototype>&& prototype );
+
+// NULL if the prototype is not found
+const Prototype* FindPrototype( const char* name );
+
+template< typename T > void DeletePrototype( void* object ) {
+  delete static_cast<T*>(object);
+}
+
+template< typename T >
+bool RegisterPrototype( const char* name , const char* klass ,
+                        const ConfigObject& config ,
+                        std::function<void* (const void*)>&& clone ) {
+  auto object = New<T>(klass,config);
+  if(!object) return false;
+
+  std::unique_ptr<Prototype> prototype(new Prototype());
+  prototype->klass   = GetKlass(klass);
+  prototype->object  = ObjectRef::Of(object.release());
+  prototype->clone   = std::move(clone);
+  prototype->destroy = &DeletePrototype<T>;
+  AddPrototype(name,std::move(prototype));
+  return true;
+}
+
+} // namespace detail
+
+// Build an object of class klass from config and register it as prototype
+// name , the copy constructor of T is used to clone it. Returns false if the
+// class is not found
+template< typename T >
+bool RegisterPrototype( const char* name , const char* klass ,
+                        const ConfigObject& config ) {
+  static_assert(std::is_copy_constructible<T>::value,
+                "prototype type is not copyable , supply a clone function");
+  return detail::RegisterPrototype<T>(name,klass,config,
+      [](const void* object) -> void* {
+        return new T(*static_cast<const T*>(object));
+      });
+}
+
+// Same as above but the prototype is cloned by clone function
+template< typename T >
+bool RegisterPrototype( const char* name , const char* klass ,
+                        const ConfigObject& config ,
+                        std::function<T* (const T&)> clone ) {
+  return detail::RegisterPrototype<T>(name,klass,config,
+      [clone = std::move(clone)](const void* object) -> void* {
+        return clone(*static_cast<const T*>(object));
+      });
+}
+
+// Create a new instance by cloning prototype name , returns null if the
+// prototype is not found. It is a fatal error if the prototype is not T
+template< typename T >
+std::unique_ptr<T> Clone( const char* name ) {
+  auto prototype = detail::FindPrototype(name);
+  if(!prototype) return std::unique_ptr<T>();
+
+  auto source = prototype->object.template As<T>();
+  if(!source) {
+    detail::Fatal("You are trying to clone prototype %s as type %s, but "
+                  "actual registered type information is %s",name,
+                  typeid(T).name(),prototype->klass->name());
+  }
+  return std::unique_ptr<T>(static_cast<T*>(prototype->clone(source)));
+}
+
+// Clone prototype name and apply overrides on top of it , the overrides go
+// through the normal setter path
+template< typename T >
+std::unique_ptr<T> Clone( const char* name , const ConfigObject& overrides ) {
+  auto object = Clone<T>(name);
+  if(object) {
+    detail::BuilderStorage storage;
+    auto kb = storage.Emplace<detail::StructKlassBuilderImpl<T>>(
+        detail::FindPrototype(name)->klass,object.get());
+    detail::Build(kb,overrides);
+  }
+  return object;
+}
+
+} // namespace dinject
+
+#endif // DINJECT_PROTOTYPE_H_
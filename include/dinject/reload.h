@@ -0,0 +1,100 @@
+#ifndef DINJECT_RELOAD_H_
+#define DINJECT_RELOAD_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "container.h"
+#include "dinject.h"
+#include "result.h"
+
+namespace dinject {
+
+/**
+ * Hot reload of a live object after its config is edited.
+ *
+ * The old and the new config are compared entry by entry and only the
+ * attributes whose value changed are set again :
+ *
+ *   primitive and string , the setter is invoked with the new value
+ *
+ *   struct , the diff is applied recursively to the struct in place
+ *
+ *   object , a new object is built from the new subtree and passed to the
+ *   setter , an unchanged subtree is not rebuilt
+ *
+ * Two nested configs are unchanged if they are the same ConfigObject or
+ * have the same entries. A key which is removed in the new config leaves
+ * the attribute as it is since there is no way to unset an attribute.
+ *
+ * A changed "@name" of an object attribute is resolved by the container
+ * the object was built with , see container.h. Without a container , or
+ * when the class of a changed subtree is not registered , the change is
+ * skipped and Apply returns false. A value which doesn't match the type of
+ * its attribute aborts the process like New , unless errors is given.
+ */
+
+namespace detail {
+
+struct DiffContext {
+  // If not NULL , "@name" is resolved to the named instance of the
+  // container , per build instances are kept in the scope
+  Container* container;
+  BuildScope* scope;
+
+  // If not NULL , a change which can't be applied is reported here , a
+  // mismatched value is skipped instead of aborting
+  std::vector<BuildError>* errors;
+
+  // Whether any change is skipped
+  bool failed;
+
+  DiffContext() :
+    container(NULL), scope(NULL), errors(NULL), failed(false) {}
+};
+
+// Apply the difference between the two configs to the object of builder ,
+// returns number of attributes set
+std::size_t ApplyDiff( KlassBuilder* builder , const ConfigObject& old_config ,
+                                               const ConfigObject& new_config ,
+                                               DiffContext* context );
+
+} // namespace detail
+
+// Re-apply changed attributes of object which was built as class name from
+// old_config. Returns false if the class is not found or is not of type T ,
+// or if any change is skipped. Number of attributes set is stored in changed
+// and the skipped changes in errors if they are not NULL. An object built
+// by Container::New passes the container to resolve "@name"
+template< typename T >
+bool Apply( T* object , const char* name , const ConfigObject& old_config ,
+                                           const ConfigObject& new_config ,
+                                           std::size_t* changed = NULL ,
+                                           std::vector<BuildError>* errors
+                                             = NULL ,
+                                           Container* container = NULL );
+
+template< typename T >
+bool Apply( T* object , const char* name , const ConfigObject& old_config ,
+                                           const ConfigObject& new_config ,
+                                           std::size_t* changed ,
+                                           std::vector<BuildError>* errors ,
+                                           Container* container ) {
+  auto klass = detail::GetKlass(name);
+  if(!klass || klass->type_id() != detail::KlassTypeId<T>::value)
+    return false;
+  detail::BuilderStorage storage;
+  auto kb = storage.Emplace<detail::StructKlassBuilderImpl<T>>(klass,object);
+  detail::BuildScope scope;
+  detail::DiffContext context;
+  context.container = container;
+  context.scope     = &scope;
+  context.errors    = errors;
+  auto count = detail::ApplyDiff(kb,old_config,new_config,&context);
+  if(changed) *changed = count;
+  return !context.failed;
+}
+
+} // namespace dinject
+
+#endif // DINJECT_RELOAD_H_
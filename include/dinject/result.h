@@ -0,0 +1,111 @@
+#ifndef DINJECT_RESULT_H_
+#define DINJECT_RESULT_H_
+
+#include "dinject.h"
+
+#include <memory>
+#include <string>
+#include <typeinfo>
+
+namespace dinject {
+
+/**
+ * Build without aborting , for configs which are not trusted , e.g. loaded
+ * from user input.
+ *
+ * New aborts the process when a config value doesn't match the type of its
+ * attribute. TryNew stops at the first mismatched value and returns the
+ * error instead , everything built so far is destroyed. Types are checked
+ * with std::get_if on both the success and the error path , no exception
+ * is thrown.
+ *
+ *   auto car = dinject::TryNew<Car>("car",*config);
+ *   if(!car) {
+ *     // object engine's attribute engine.power expect type int64 , got string
+ *     std::cerr << car.error().ToString();
+ *     return;
+ *   }
+ *   car->Drive();
+ */
+
+struct BuildError {
+  enum Code {
+    kOk,
+    kUnknownClass,   // no class is registered with the name
+    kWrongType,      // the class doesn't create objects of the requested T
+    kTypeMismatch,   // a config value doesn't match the type of attribute
+    kUnknownKey      // a config key is not an attribute , see Validate
+  };
+
+  Code code;
+  std::string klass;     // class of the object whose attribute failed
+  std::string path;      // attribute path from the root , e.g. engine.power
+  std::string expected;  // type of the attribute
+  std::string actual;    // type of the config value
+
+  BuildError() : code(kOk), klass(), path(), expected(), actual() {}
+
+  // Human readable description
+  std::string ToString() const;
+};
+
+// Either the built object or the error which stopped the build
+template< typename T >
+class Result {
+ public:
+  explicit Result( std::unique_ptr<T>&& value ):
+    value_(std::move(value)), error_()
+  {}
+
+  explicit Result( BuildError&& error ):
+    value_(), error_(std::move(error))
+  {}
+
+  bool ok() const { return error_.code == BuildError::kOk; }
+  explicit operator bool () const { return ok(); }
+
+  const BuildError& error() const { return error_; }
+
+  T* get() const { return value_.get(); }
+  T* operator -> () const { return value_.get(); }
+  T& operator *  () const { return *value_; }
+
+  // Take the object out of the result
+  std::unique_ptr<T> Release() { return std::move(value_); }
+
+ private:
+  std::unique_ptr<T> value_;
+  BuildError error_;
+};
+
+// Create an object of type T with certain name of given input config ,
+// returns the error instead of aborting on a bad config
+template< typename T >
+Result<T> TryNew( const char* name , const ConfigObject& config ) {
+  BuildError error;
+  auto symbol = FindSymbol(name);
+  auto klass  = symbol != kNoSymbol ? detail::GetKlass(symbol) : NULL;
+  if(!klass) {
+    error.code  = BuildError::kUnknownClass;
+    error.klass = name;
+    return Result<T>(std::move(error));
+  }
+  if(klass->type_id() != detail::KlassTypeId<T>::value) {
+    error.code     = BuildError::kWrongType;
+    error.klass    = name;
+    error.expected = typeid(T).name();
+    return Result<T>(std::move(error));
+  }
+
+  detail::BuilderStorage storage;
+  auto kb = detail::NewKlassObject(symbol,&storage);
+  detail::BuildContext context;
+  context.error = &error;
+  detail::Build(kb,config,&context);
+  if(context.failed) return Result<T>(std::move(error));
+  return Result<T>(kb->Get<T>());
+}
+
+} // namespace dinject
+
+#endif // DINJECT_RESULT_H_
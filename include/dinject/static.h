@@ -0,0 +1,249 @@
+#ifndef DINJECT_STATIC_H_
+#define DINJECT_STATIC_H_
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "dinject.h"
+
+namespace dinject {
+
+/**
+ * Compile time class descriptor , an alternative to runtime registration
+ * with Class<T>().
+ *
+ * A class is described by specializing StaticClass with a constexpr tuple of
+ * attributes. Each attribute is either a data member or a setter , the kind
+ * is deduced from the member pointer:
+ *
+ *   DINJECT_STATIC_CLASS(MyObject) {
+ *     static constexpr auto attributes = std::make_tuple(
+ *       dinject::Attr("x"  ,&MyObject::x),          // data member
+ *       dinject::Attr("str",&MyObject::SetStr),     // setter
+ *       dinject::Attr("pos",&MyObject::pos),        // nested static class
+ *       dinject::Attr("sub",&MyObject::SetSub));    // setter of Sub*
+ *   };
+ *
+ * The name lookup table is sorted at compile time and each attribute is
+ * dispatched through its own instantiated function , so the setter can be
+ * inlined. New<T>(config) doesn't touch the registry , nothing is allocated
+ * or registered during static initialization.
+ */
+template< typename T > struct StaticClass {};
+
+template< typename M > struct StaticAttribute {
+  std::string_view name;
+  M member;
+};
+
+// Create a static attribute with a data member or setter pointer
+template< typename M >
+constexpr StaticAttribute<M> Attr( std::string_view name , M member ) {
+  return StaticAttribute<M>{name,member};
+}
+
+namespace detail {
+
+template< typename T , typename = void >
+struct HasStaticClass : std::false_type {};
+
+template< typename T >
+struct HasStaticClass<T,std::void_t<decltype(StaticClass<T>::attributes)>> :
+  std::true_type {};
+
+template< typename T > void BuildStatic( T* , const ConfigObject& );
+
+// Convert config value into a value of type X , returns false on mismatch
+template< typename X >
+bool StaticConvert( const ConfigValue& value , X* output ) {
+  if constexpr (std::is_same<X,std::string>::value) {
+    auto v = std::get_if<std::string>(&value);
+    if(!v) return false;
+    *output = *v;
+    return true;
+  } else if constexpr (std::is_arithmetic<X>::value) {
+    typedef typename MapPrimitiveCppTypeToUniversalType<X>::type FromType;
+    FromType v = FromType();
+    if(!GetPrimitive(value,&v)) return false;
+    *output = static_cast<X>(v);
+    return true;
+  } else {
+    static_assert(HasStaticClass<X>::value,
+                  "static attribute type must be primitive , string or a "
+                  "class with StaticClass");
+    auto v = std::get_if<std::shared_ptr<ConfigObject>>(&value);
+    if(!v || !*v) return false;
+    BuildStatic(output,**v);
+    return true;
+  }
+}
+
+template< typename T , typename C , typename X >
+bool StaticSet( T* object , X C::* field , const ConfigValue& value ) {
+  return StaticConvert(value,&(object->*field));
+}
+
+template< typename T , typename C , typename X >
+bool StaticSet( T* object , void (C::*setter)( X ) , const ConfigValue& value ) {
+  typedef typename std::decay<X>::type D;
+  if constexpr (std::is_pointer<D>::value) {
+    typedef typename std::remove_pointer<D>::type U;
+    static_assert(HasStaticClass<U>::value,
+                  "object setter must take a class with StaticClass");
+    auto v = std::get_if<std::shared_ptr<ConfigObject>>(&value);
+    if(!v || !*v) return false;
+    std::unique_ptr<U> sub(new U());
+    BuildStatic(sub.get(),**v);
+    (object->*setter)(sub.release());
+    return true;
+  } else if constexpr (std::is_same<X,const std::string&>::value) {
+    // borrow the string from config instead of copying it
+    auto v = std::get_if<std::string>(&value);
+    if(!v) return false;
+    (object->*setter)(*v);
+    return true;
+  } else {
+    D v;
+    if(!StaticConvert(value,&v)) return false;
+    (object->*setter)(std::move(v));
+    return true;
+  }
+}
+
+template< typename T , std::size_t I >
+void StaticApply( T* object , const ConfigValue& value ) {
+  constexpr auto& attr = std::get<I>(StaticClass<T>::attributes);
+  if(!StaticSet(object,attr.member,value)) {
+    Fatal("static class %s's attribute %.*s has mismatched type",
+          typeid(T).name(),static_cast<int>(attr.name.size()),
+          attr.name.data());
+  }
+}
+
+// Name of attribute and its index in the descriptor
+struct StaticEntry {
+  std::string_view name;
+  std::size_t index;
+};
+
+template< typename T , std::size_t... I >
+constexpr auto StaticSort( std::index_sequence<I...> ) {
+  std::array<StaticEntry,sizeof...(I)> table{{
+    StaticEntry{std::get<I>(StaticClass<T>::attributes).name,I}... }};
+  // insertion sort , std::sort is not constexpr
+  for( std::size_t i = 1 ; i < table.size() ; ++i ) {
+    for( std::size_t j = i ; j > 0 && table[j].name < table[j-1].name ; --j ) {
+      auto temp  = table[j];
+      table[j]   = table[j-1];
+      table[j-1] = temp;
+    }
+  }
+  return table;
+}
+
+template< std::size_t N >
+constexpr bool StaticUnique( const std::array<StaticEntry,N>& table ) {
+  for( std::size_t i = 1 ; i < N ; ++i ) {
+    if(table[i].name == table[i-1].name) return false;
+  }
+  return true;
+}
+
+template< typename T , std::size_t... I >
+constexpr auto StaticSetters( std::index_sequence<I...> ) {
+  typedef void (*Setter)( T* , const ConfigValue& );
+  return std::array<Setter,sizeof...(I)>{{ &StaticApply<T,I>... }};
+}
+
+// Compile time lookup table of a static class
+template< typename T > class StaticTable {
+ public:
+  typedef typename std::decay<decltype(StaticClass<T>::attributes)>::type
+    Attributes;
+
+  static constexpr std::size_t kSize = std::tuple_size<Attributes>::value;
+  static constexpr std::size_t kNotFound = kSize;
+
+  // Attribute entries sorted by name
+  static constexpr auto kSorted =
+    StaticSort<T>(std::make_index_sequence<kSize>());
+
+  // Setter of each attribute , indexed by position in the descriptor
+  static constexpr auto kSetter =
+    StaticSetters<T>(std::make_index_sequence<kSize>());
+
+  static_assert(StaticUnique(kSorted),
+                "duplicated attribute name in static class");
+
+  // Index of the attribute in the descriptor , kNotFound if not found
+  static constexpr std::size_t Find( std::string_view name ) {
+    std::size_t lo = 0 , hi = kSize;
+    while(lo < hi) {
+      auto mid = lo + (hi - lo) / 2;
+      if(kSorted[mid].name < name)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+    return (lo < kSize && kSorted[lo].name == name) ? kSorted[lo].index :
+                                                      kNotFound;
+  }
+
+  // Set attribute index of object
+  static void Set( T* object , std::size_t index , const ConfigValue& value ) {
+    kSetter[index](object,value);
+  }
+};
+
+template< typename T >
+class StaticBuildVisitor : public ConfigObject::Visitor {
+ public:
+  explicit StaticBuildVisitor( T* object ) : object_(object) {}
+
+  virtual void Visit( std::string_view key , Symbol ,
+                                             const ConfigValue& value ) {
+    auto index = StaticTable<T>::Find(key);
+    if(index != StaticTable<T>::kNotFound)
+      StaticTable<T>::Set(object_,index,value);
+  }
+
+ private:
+  T* object_;
+};
+
+template< typename T >
+void BuildStatic( T* object , const ConfigObject& config ) {
+  StaticBuildVisitor<T> visitor(object);
+  config.ForEach(&visitor);
+}
+
+} // namespace detail
+
+// Create an object of a static class from config , the registry is not used
+template< typename T >
+std::unique_ptr<T> New( const ConfigObject& config ) {
+  static_assert(detail::HasStaticClass<T>::value,
+                "New<T>(config) requires StaticClass<T>");
+  std::unique_ptr<T> object(new T());
+  detail::BuildStatic(object.get(),config);
+  return object;
+}
+
+// Inject config into an already constructed object of a static class
+template< typename T >
+void Build( T* object , const ConfigObject& config ) {
+  static_assert(detail::HasStaticClass<T>::value,
+                "Build(T*,config) requires StaticClass<T>");
+  detail::BuildStatic(object,config);
+}
+
+#define DINJECT_STATIC_CLASS _DINJECT_STATIC_CLASS_V0
+
+} // namespace dinject
+
+#endif // DINJECT_STATIC_H_
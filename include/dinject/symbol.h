@@ -0,0 +1,35 @@
+#ifndef DINJECT_SYMBOL_H_
+#define DINJECT_SYMBOL_H_
+
+#include <cstdint>
+#include <string_view>
+
+namespace dinject {
+
+// Symbol is a small integer id of an interned name. Class and attribute
+// names are interned when they are registered , so lookup by Symbol is an
+// integer comparison instead of string hashing/comparison
+typedef std::uint32_t Symbol;
+
+// Symbol of a name which is not interned
+static const Symbol kNoSymbol = 0;
+
+// Intern a name and return its Symbol , the same name always gets the
+// same Symbol. The name is copied into the symbol table
+Symbol Intern( std::string_view name );
+
+// Find the Symbol of a name without interning it , returns kNoSymbol if
+// the name is not interned. Since all registered names are interned, a
+// kNoSymbol result means no class or attribute has this name at the moment
+Symbol FindSymbol( std::string_view name );
+
+// Get the interned name of a Symbol , returns NULL for unknown Symbol
+const char* GetSymbolName( Symbol symbol );
+
+// Disallow interning new names , after that the table is read only and can
+// be used by multiple threads. Called by Freeze
+void FreezeSymbolTable();
+
+} // namespace dinject
+
+#endif // DINJECT_SYMBOL_H_
@@ -0,0 +1,101 @@
+#ifndef DINJECT_TRACE_H_
+#define DINJECT_TRACE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+#include "symbol.h"
+
+namespace dinject {
+
+/**
+ * Construction tracing , compiled in only when DINJECT_TRACE is defined.
+ *
+ * Like profiling the library and every translation unit including dinject
+ * must be built with the same setting , e.g. make TRACE=1. When it is not
+ * defined the instrumentation macros expand to nothing.
+ *
+ * Between StartTrace and StopTrace every build of an object , every nested
+ * object and struct attribute and every setter records a begin and an end
+ * event into a ring buffer owned by the current thread , so recording never
+ * takes a lock. FlushTrace drains the rings of all threads as a Chrome
+ * trace event JSON file , which can be opened by chrome://tracing or
+ * Perfetto. Events are named by the class or the attribute and the
+ * category tells what they are :
+ *
+ *   new    , building an object of the class
+ *   object , creating a nested object attribute and passing it to its setter
+ *   struct , building a nested struct attribute
+ *   setter , invoking a setter or writing a field
+ *
+ * When the ring of a thread is full new spans are dropped as a whole , a
+ * recorded span always gets its end event. Spans which are open during
+ * FlushTrace are split across two flushes , flush after the load is done
+ * to get a well formed file.
+ */
+
+// Number of events a thread can buffer between two flushes
+static const std::size_t kTraceRingSize = 1 << 16;
+
+// Whether the library is compiled with DINJECT_TRACE
+bool TraceEnabled();
+
+// Start and stop recording , does nothing if tracing is compiled out
+void StartTrace();
+void StopTrace();
+
+// Write the buffered events of all threads as Chrome trace event JSON and
+// remove them from the buffers , returns the number of events written
+std::size_t FlushTrace( std::FILE* output );
+
+// Number of spans dropped because the ring of their thread was full
+std::uint64_t TraceDropped();
+
+namespace detail {
+
+#ifdef DINJECT_TRACE
+
+enum TraceKind {
+  kTraceNew,
+  kTraceObject,
+  kTraceStruct,
+  kTraceSetter
+};
+
+// Record the begin event of a span , returns false if it is not recorded ,
+// then its end event must not be recorded either
+bool TraceBegin( TraceKind kind , Symbol name );
+void TraceEnd  ( TraceKind kind , Symbol name );
+
+// Record a span for its scope
+class TraceSpan {
+ public:
+  TraceSpan( TraceKind kind , Symbol name ):
+    kind_(kind), name_(name), recorded_(TraceBegin(kind,name))
+  {}
+
+  ~TraceSpan() {
+    if(recorded_) TraceEnd(kind_,name_);
+  }
+
+ private:
+  TraceKind kind_;
+  Symbol name_;
+  bool recorded_;
+};
+
+#define DINJECT_TRACE_SPAN(KIND,NAME)                                        \
+  ::dinject::detail::TraceSpan _dinject_trace_##KIND(                        \
+      ::dinject::detail::kTrace##KIND,(NAME))
+
+#else
+
+#define DINJECT_TRACE_SPAN(KIND,NAME) ((void)0)
+
+#endif // DINJECT_TRACE
+
+} // namespace detail
+} // namespace dinject
+
+#endif // DINJECT_TRACE_H_
@@ -0,0 +1,40 @@
+#ifndef DINJECT_VALIDATE_H_
+#define DINJECT_VALIDATE_H_
+
+#include <vector>
+
+#include "dinject.h"
+#include "result.h"
+
+namespace dinject {
+
+/**
+ * Check a config against the attribute tables of a class once , before
+ * lots of objects are built from it.
+ *
+ * The config is walked recursively without creating any object , all
+ * problems are reported in one pass :
+ *
+ *   kTypeMismatch , the value doesn't match the type of the attribute
+ *
+ *   kUnknownKey   , the key is not an attribute of the class , which the
+ *                   build silently ignores
+ *
+ *   kUnknownClass , the class itself or the class of an object or struct
+ *                   attribute is not registered
+ *
+ * A config without any kTypeMismatch or kUnknownClass error never makes
+ * New abort on a type check. A string "@name" is only accepted for an
+ * attribute added with AddShared and when references is true , i.e. the
+ * config is built through Container::New which resolves it , the plain
+ * New rejects it.
+ */
+
+// Returns every problem of the config , empty if it is valid
+std::vector<BuildError> Validate( const char* klass ,
+                                  const ConfigObject& config ,
+                                  bool references = false );
+
+} // namespace dinject
+
+#endif // DINJECT_VALIDATE_H_
@@ -0,0 +1,91 @@
+#include "arena.h"
+#include "error.h"
+
+#include <cstdint>
+#include <cstdlib>
+
+namespace dinject {
+
+Arena::Arena( std::size_t block_size ):
+  blocks_(NULL),
+  cursor_(NULL),
+  end_(NULL),
+  finalizers_(NULL),
+  block_size_(block_size),
+  size_(0)
+{}
+
+Arena::~Arena() {
+  RunFinalizer();
+  while(blocks_) {
+    auto next = blocks_->next;
+    std::free(blocks_);
+    blocks_ = next;
+  }
+}
+
+void Arena::NewBlock( std::size_t size ) {
+  auto total = sizeof(Block) + size;
+  auto block = static_cast<Block*>(std::malloc(total));
+  if(!block) detail::Fatal("arena is out of memory , requested %zu",total);
+
+  block->next = blocks_;
+  block->size = size;
+  blocks_ = block;
+  cursor_ = reinterpret_cast<char*>(block + 1);
+  end_    = cursor_ + size;
+}
+
+void* Arena::Allocate( std::size_t size , std::size_t alignment ) {
+  auto aligned = [&]() {
+    auto p = reinterpret_cast<std::uintptr_t>(cursor_);
+    return reinterpret_cast<char*>((p + alignment - 1) & ~(alignment - 1));
+  };
+
+  char* ptr = cursor_ ? aligned() : NULL;
+  if(!ptr || ptr + size > end_) {
+    // oversized allocation gets its own block
+    auto need = size + alignment;
+    NewBlock(need > block_size_ ? need : block_size_);
+    ptr = aligned();
+  }
+
+  cursor_ = ptr + size;
+  size_  += size;
+  return ptr;
+}
+
+void Arena::AddFinalizer( void (*destroy)( void* ) , void* object ) {
+  auto f = ::new (Allocate(sizeof(Finalizer),alignof(Finalizer))) Finalizer;
+  f->destroy = destroy;
+  f->object  = object;
+  f->next    = finalizers_;
+  finalizers_= f;
+}
+
+void Arena::RunFinalizer() {
+  // finalizers are linked in reverse order of creation
+  while(finalizers_) {
+    auto f = finalizers_;
+    finalizers_ = f->next;
+    f->destroy(f->object);
+  }
+}
+
+void Arena::Reset() {
+  RunFinalizer();
+
+  if(blocks_) {
+    // keep the oldest block around for reuse
+    while(blocks_->next) {
+      auto next = blocks_->next;
+      std::free(blocks_);
+      blocks_ = next;
+    }
+    cursor_ = reinterpret_cast<char*>(blocks_ + 1);
+    end_    = cursor_ + blocks_->size;
+  }
+  size_ = 0;
+}
+
+} // namespace dinject
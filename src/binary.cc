@@ -0,0 +1,518 @@
+#include "binary.h"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace dinject {
+
+namespace {
+
+// Layout of the file , every section is 8 bytes aligned
+//
+//   Header
+//   KeyRecord    keys   [key_count]
+//   std::uint32_t objects[object_count]   offset of each object
+//   ObjectRecord + EntryRecord[count]   for each object
+//   string pool , each string is NUL terminated
+const std::uint32_t kMagic   = 0x46434a44; // DJCF
+const std::uint32_t kVersion = 1;
+
+struct Header {
+  std::uint32_t magic;
+  std::uint32_t version;
+  std::uint32_t size;
+  std::uint32_t key_count;
+  std::uint32_t key_table;
+  std::uint32_t object_count;
+  std::uint32_t object_table;
+  std::uint32_t pool;
+};
+
+struct KeyRecord {
+  std::uint32_t offset;
+  std::uint32_t length;
+};
+
+struct ObjectRecord {
+  std::uint32_t count;
+  std::uint32_t padding;
+};
+
+// type is the index of the alternative in ConfigValue
+enum EntryType {
+  kEntryBool,
+  kEntryInt,
+  kEntryReal,
+  kEntryString,
+  kEntryObject
+};
+
+struct EntryRecord {
+  std::uint32_t key;
+  std::uint32_t type;
+  union {
+    std::uint64_t boolean;
+    std::int64_t integer;
+    double real;
+    KeyRecord string;
+    std::uint32_t object;   // index into the object table
+  };
+};
+
+static_assert(sizeof(Header) == 32 && sizeof(EntryRecord) == 16 &&
+              sizeof(ObjectRecord) == 8 , "unexpected binary layout");
+
+inline std::size_t Align( std::size_t v ) { return (v + 7) & ~std::size_t(7); }
+
+// --------------------------------------------------------------------------
+// Writer
+// --------------------------------------------------------------------------
+class BinaryWriter : public ConfigObject::Visitor {
+ public:
+  BinaryWriter() : keys_(), key_index_(), objects_(), pool_(), current_(0) {}
+
+  void Add( const ConfigObject& config ) {
+    auto index = static_cast<std::uint32_t>(objects_.size());
+    objects_.emplace_back();
+    auto parent = current_;
+    current_ = index;
+    config.ForEach(this);
+    current_ = parent;
+  }
+
+  virtual void Visit( std::string_view key , Symbol ,
+                                             const ConfigValue& value ) {
+    EntryRecord entry;
+    std::memset(&entry,0,sizeof(entry));
+    entry.key  = Key(key);
+    entry.type = static_cast<std::uint32_t>(value.index());
+    switch(value.index()) {
+      case kEntryBool:   entry.boolean = std::get<bool>(value); break;
+      case kEntryInt:    entry.integer = std::get<std::int64_t>(value); break;
+      case kEntryReal:   entry.real    = std::get<double>(value); break;
+      case kEntryString: entry.string  = String(std::get<std::string>(value));
+                         break;
+      default:
+        {
+          auto &obj = std::get<std::shared_ptr<ConfigObject>>(value);
+          if(!obj) return;
+          // children are always after the parent , so there is no cycle
+          entry.object = static_cast<std::uint32_t>(objects_.size());
+          objects_[current_].push_back(entry);
+          Add(*obj);
+          return;
+        }
+    }
+    objects_[current_].push_back(entry);
+  }
+
+  virtual void VisitString( std::string_view key , Symbol ,
+                                                   std::string_view value ) {
+    EntryRecord entry;
+    std::memset(&entry,0,sizeof(entry));
+    entry.key    = Key(key);
+    entry.type   = kEntryString;
+    entry.string = String(value);
+    objects_[current_].push_back(entry);
+  }
+
+  bool Finish( std::string* output );
+
+ private:
+  std::uint32_t Key( std::string_view key ) {
+    auto itr = key_index_.find(key);
+    if(itr != key_index_.end()) return itr->second;
+    auto index = static_cast<std::uint32_t>(keys_.size());
+    keys_.push_back(String(key));
+    key_index_.emplace(std::string(key),index);
+    return index;
+  }
+
+  KeyRecord String( std::string_view value ) {
+    KeyRecord record{static_cast<std::uint32_t>(pool_.size()),
+                     static_cast<std::uint32_t>(value.size())};
+    pool_.append(value.data(),value.size());
+    pool_.push_back('\0');
+    return record;
+  }
+
+  std::vector<KeyRecord> keys_;
+  std::map<std::string,std::uint32_t,std::less<>> key_index_;
+  std::vector<std::vector<EntryRecord>> objects_;
+  std::string pool_;
+  std::uint32_t current_;
+};
+
+bool BinaryWriter::Finish( std::string* output ) {
+  Header header;
+  header.magic        = kMagic;
+  header.version      = kVersion;
+  header.key_count    = static_cast<std::uint32_t>(keys_.size());
+  header.key_table    = static_cast<std::uint32_t>(sizeof(Header));
+  header.object_count = static_cast<std::uint32_t>(objects_.size());
+  header.object_table = static_cast<std::uint32_t>(
+      Align(header.key_table + keys_.size() * sizeof(KeyRecord)));
+
+  std::size_t offset = Align(header.object_table +
+                             objects_.size() * sizeof(std::uint32_t));
+  std::vector<std::uint32_t> object_table;
+  for( auto &e : objects_ ) {
+    object_table.push_back(static_cast<std::uint32_t>(offset));
+    offset += sizeof(ObjectRecord) + e.size() * sizeof(EntryRecord);
+  }
+  std::size_t size = offset + pool_.size();
+  if(size > UINT32_MAX) return false;
+
+  header.pool = static_cast<std::uint32_t>(offset);
+  header.size = static_cast<std::uint32_t>(size);
+
+  for( auto &e : keys_ ) e.offset += header.pool;
+  for( auto &o : objects_ ) {
+    for( auto &e : o ) {
+      if(e.type == kEntryString) e.string.offset += header.pool;
+    }
+  }
+
+  output->assign(size,'\0');
+  auto base = &(*output)[0];
+  std::memcpy(base,&header,sizeof(header));
+  if(!keys_.empty())
+    std::memcpy(base + header.key_table,keys_.data(),
+                keys_.size() * sizeof(KeyRecord));
+  if(!object_table.empty())
+    std::memcpy(base + header.object_table,object_table.data(),
+                object_table.size() * sizeof(std::uint32_t));
+  for( std::size_t i = 0 ; i < objects_.size() ; ++i ) {
+    ObjectRecord record{static_cast<std::uint32_t>(objects_[i].size()),0};
+    std::memcpy(base + object_table[i],&record,sizeof(record));
+    if(!objects_[i].empty())
+      std::memcpy(base + object_table[i] + sizeof(record),objects_[i].data(),
+                  objects_[i].size() * sizeof(EntryRecord));
+  }
+  if(!pool_.empty()) std::memcpy(base + header.pool,pool_.data(),pool_.size());
+  return true;
+}
+
+// --------------------------------------------------------------------------
+// Reader
+// --------------------------------------------------------------------------
+class BinaryConfig;
+
+class BinaryConfigObject : public ConfigObject {
+ public:
+  BinaryConfigObject( BinaryConfig* file , const ObjectRecord* record ):
+    file_(file), record_(record), cache_()
+  {}
+
+  virtual const ConfigValue* Get( const char* name ) const {
+    return Find(name);
+  }
+  virtual const ConfigValue* Get( const std::string& name ) const {
+    return Find(name);
+  }
+
+  virtual void Set( const char* , const ConfigValue& ) {
+    detail::Fatal("binary config is read only");
+  }
+  virtual void Set( const std::string& , const ConfigValue& ) {
+    detail::Fatal("binary config is read only");
+  }
+
+  virtual std::unique_ptr<Iterator> NewIterator() const;
+  virtual void ForEach( Visitor* visitor ) const;
+
+  std::uint32_t count() const { return record_->count; }
+  const EntryRecord* entry( std::uint32_t i ) const {
+    return reinterpret_cast<const EntryRecord*>(record_ + 1) + i;
+  }
+
+  // Materialize the value of entry i , a nested object keeps the file alive
+  // if owning is true
+  ConfigValue Value( std::uint32_t i , bool owning ) const;
+
+ private:
+  const ConfigValue* Find( std::string_view name ) const;
+
+  BinaryConfig* file_;
+  const ObjectRecord* record_;
+
+  // values materialized by Get , guarded by the lock of the file
+  mutable std::map<std::uint32_t,ConfigValue> cache_;
+};
+
+class BinaryConfig : public std::enable_shared_from_this<BinaryConfig> {
+ public:
+  BinaryConfig():
+    data_(), map_(NULL), map_size_(0), base_(NULL), header_(NULL),
+    symbols_(), objects_(), lock_()
+  {}
+
+  ~BinaryConfig() {
+    if(map_) ::munmap(map_,map_size_);
+  }
+
+  bool Map( const char* path , std::string* error );
+  bool Load( std::string&& data , std::string* error );
+
+  std::shared_ptr<ConfigObject> root() { return object(0); }
+
+  // View of object i which keeps the file alive
+  std::shared_ptr<ConfigObject> object( std::uint32_t i ) {
+    return std::shared_ptr<ConfigObject>(shared_from_this(),&objects_[i]);
+  }
+
+  // View of object i which doesn't own the file , used by the values cached
+  // inside of the file itself otherwise the file would own itself
+  std::shared_ptr<ConfigObject> borrow( std::uint32_t i ) {
+    return std::shared_ptr<ConfigObject>(std::shared_ptr<void>(),&objects_[i]);
+  }
+
+  std::string_view key( std::uint32_t i ) const {
+    return String(KeyTable()[i]);
+  }
+  Symbol symbol( std::uint32_t i ) const { return symbols_[i]; }
+
+  std::string_view String( const KeyRecord& record ) const {
+    return std::string_view(base_ + record.offset,record.length);
+  }
+
+  std::mutex& lock() { return lock_; }
+
+ private:
+  bool Validate( std::size_t size , std::string* error );
+  bool Fail( std::string* error , const char* message ) {
+    if(error) *error = message;
+    return false;
+  }
+
+  const KeyRecord* KeyTable() const {
+    return reinterpret_cast<const KeyRecord*>(base_ + header_->key_table);
+  }
+
+  std::string data_;
+  void* map_;
+  std::size_t map_size_;
+  const char* base_;
+  const Header* header_;
+  std::vector<Symbol> symbols_;
+  std::vector<BinaryConfigObject> objects_;
+  std::mutex lock_;
+};
+
+bool BinaryConfig::Map( const char* path , std::string* error ) {
+  int fd = ::open(path,O_RDONLY);
+  if(fd < 0) return Fail(error,"cannot open file");
+  struct stat st;
+  if(::fstat(fd,&st) != 0 || st.st_size == 0) {
+    ::close(fd);
+    return Fail(error,"cannot stat file or file is empty");
+  }
+  map_size_ = static_cast<std::size_t>(st.st_size);
+  map_ = ::mmap(NULL,map_size_,PROT_READ,MAP_PRIVATE,fd,0);
+  ::close(fd);
+  if(map_ == MAP_FAILED) {
+    map_ = NULL;
+    return Fail(error,"cannot mmap file");
+  }
+  base_ = static_cast<const char*>(map_);
+  return Validate(map_size_,error);
+}
+
+bool BinaryConfig::Load( std::string&& data , std::string* error ) {
+  data_ = std::move(data);
+  base_ = data_.data();
+  if(reinterpret_cast<std::uintptr_t>(base_) % alignof(std::uint64_t) != 0)
+    return Fail(error,"buffer is not aligned");
+  return Validate(data_.size(),error);
+}
+
+bool BinaryConfig::Validate( std::size_t size , std::string* error ) {
+  if(size < sizeof(Header)) return Fail(error,"file is too small");
+  header_ = reinterpret_cast<const Header*>(base_);
+  auto &h = *header_;
+  if(h.magic != kMagic)     return Fail(error,"not a binary config");
+  if(h.version != kVersion) return Fail(error,"unsupported version");
+  if(h.size != size)        return Fail(error,"file size mismatch");
+  if(h.object_count == 0)   return Fail(error,"no root object");
+
+  auto in = [&]( std::size_t offset , std::size_t length ) {
+    return offset <= size && length <= size - offset;
+  };
+  auto in_pool = [&]( const KeyRecord& r ) {
+    return r.offset >= h.pool && in(r.offset,std::size_t(r.length) + 1) &&
+           base_[r.offset + r.length] == '\0';
+  };
+
+  if(h.key_table % 8 || h.object_table % 8 ||
+     !in(h.key_table,std::size_t(h.key_count) * sizeof(KeyRecord)) ||
+     !in(h.object_table,std::size_t(h.object_count) * sizeof(std::uint32_t)) ||
+     !in(h.pool,0))
+    return Fail(error,"corrupted table");
+
+  symbols_.reserve(h.key_count);
+  for( std::uint32_t i = 0 ; i < h.key_count ; ++i ) {
+    if(!in_pool(KeyTable()[i])) return Fail(error,"corrupted key");
+    symbols_.push_back(FindSymbol(key(i)));
+  }
+
+  auto table = reinterpret_cast<const std::uint32_t*>(base_ + h.object_table);
+  objects_.reserve(h.object_count);
+  for( std::uint32_t i = 0 ; i < h.object_count ; ++i ) {
+    auto offset = table[i];
+    if(offset % 8 || !in(offset,sizeof(ObjectRecord)))
+      return Fail(error,"corrupted object");
+    auto record = reinterpret_cast<const ObjectRecord*>(base_ + offset);
+    if(!in(offset + sizeof(ObjectRecord),
+           std::size_t(record->count) * sizeof(EntryRecord)))
+      return Fail(error,"corrupted object");
+
+    objects_.emplace_back(this,record);
+    auto &obj = objects_.back();
+    for( std::uint32_t j = 0 ; j < obj.count() ; ++j ) {
+      auto e = obj.entry(j);
+      if(e->key >= h.key_count) return Fail(error,"corrupted entry key");
+      switch(e->type) {
+        case kEntryBool:
+        case kEntryInt:
+        case kEntryReal:
+          break;
+        case kEntryString:
+          if(!in_pool(e->string)) return Fail(error,"corrupted string");
+          break;
+        case kEntryObject:
+          // child must come after its parent , which rules out cycles
+          if(e->object <= i || e->object >= h.object_count)
+            return Fail(error,"corrupted object reference");
+          break;
+        default:
+          return Fail(error,"corrupted entry type");
+      }
+    }
+  }
+  return true;
+}
+
+ConfigValue BinaryConfigObject::Value( std::uint32_t i , bool owning ) const {
+  auto e = entry(i);
+  switch(e->type) {
+    case kEntryBool:   return ConfigValue(e->boolean != 0);
+    case kEntryInt:    return ConfigValue(e->integer);
+    case kEntryReal:   return ConfigValue(e->real);
+    case kEntryString: return ConfigValue(std::string(file_->String(e->string)));
+    default:           return ConfigValue(owning ? file_->object(e->object) :
+                                                   file_->borrow(e->object));
+  }
+}
+
+const ConfigValue* BinaryConfigObject::Find( std::string_view name ) const {
+  for( std::uint32_t i = 0 ; i < count() ; ++i ) {
+    if(file_->key(entry(i)->key) != name) continue;
+    std::lock_guard<std::mutex> guard(file_->lock());
+    auto itr = cache_.find(i);
+    if(itr == cache_.end()) itr = cache_.emplace(i,Value(i,false)).first;
+    return &itr->second;
+  }
+  return NULL;
+}
+
+void BinaryConfigObject::ForEach( Visitor* visitor ) const {
+  for( std::uint32_t i = 0 ; i < count() ; ++i ) {
+    auto e   = entry(i);
+    auto key = file_->key(e->key);
+    auto sym = file_->symbol(e->key);
+    switch(e->type) {
+      case kEntryBool:
+        visitor->Visit(key,sym,ConfigValue(e->boolean != 0));
+        break;
+      case kEntryInt:
+        visitor->Visit(key,sym,ConfigValue(e->integer));
+        break;
+      case kEntryReal:
+        visitor->Visit(key,sym,ConfigValue(e->real));
+        break;
+      case kEntryString:
+        visitor->VisitString(key,sym,file_->String(e->string));
+        break;
+      default:
+        visitor->Visit(key,sym,ConfigValue(file_->object(e->object)));
+        break;
+    }
+  }
+}
+
+class BinaryConfigIterator : public ConfigObject::Iterator {
+ public:
+  BinaryConfigIterator( const BinaryConfigObject* object ,
+                        const BinaryConfig* file ):
+    object_(object), file_(file), index_(0)
+  {}
+
+  virtual bool HasNext() const { return index_ < object_->count(); }
+
+  virtual bool Next() {
+    ++index_;
+    return HasNext();
+  }
+
+  virtual void Get( std::string* key , ConfigValue* output ) {
+    assert(HasNext());
+    *key    = file_->key(object_->entry(index_)->key);
+    *output = object_->Value(index_,true);
+  }
+
+  virtual Symbol GetSymbol() const {
+    assert(HasNext());
+    return file_->symbol(object_->entry(index_)->key);
+  }
+
+ private:
+  const BinaryConfigObject* object_;
+  const BinaryConfig* file_;
+  std::uint32_t index_;
+};
+
+std::unique_ptr<ConfigObject::Iterator> BinaryConfigObject::NewIterator() const {
+  return std::unique_ptr<Iterator>(new BinaryConfigIterator(this,file_));
+}
+
+} // namespace
+
+bool WriteBinaryConfig( const ConfigObject& config , std::string* output ) {
+  BinaryWriter writer;
+  writer.Add(config);
+  return writer.Finish(output);
+}
+
+bool WriteBinaryConfig( const ConfigObject& config , const char* path ) {
+  std::string data;
+  if(!WriteBinaryConfig(config,&data)) return false;
+  std::ofstream output(path,std::ios::binary | std::ios::trunc);
+  output.write(data.data(),data.size());
+  return static_cast<bool>(output);
+}
+
+std::shared_ptr<ConfigObject> OpenBinaryConfig( const char* path ,
+                                                std::string* error ) {
+  auto file = std::make_shared<BinaryConfig>();
+  if(!file->Map(path,error)) return std::shared_ptr<ConfigObject>();
+  return file->root();
+}
+
+std::shared_ptr<ConfigObject> LoadBinaryConfig( std::string data ,
+                                                std::string* error ) {
+  auto file = std::make_shared<BinaryConfig>();
+  if(!file->Load(std::move(data),error)) return std::shared_ptr<ConfigObject>();
+  return file->root();
+}
+
+} // namespace dinject
@@ -0,0 +1,136 @@
+#include "container.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace dinject {
+
+struct Container::Entry {
+  std::string name;
+  Symbol klass;
+  std::shared_ptr<ConfigObject> config;
+  Scope scope;
+
+  // Singleton instance once it is created
+  detail::SharedRef instance;
+
+  // Whether the singleton is being created
+  bool building;
+};
+
+Container::Container():
+  entries_(),
+  lock_()
+{}
+
+Container::~Container() {}
+
+void Container::Register( const char* name , const char* klass ,
+                          std::shared_ptr<ConfigObject> config ,
+                          Scope scope ) {
+  std::unique_ptr<Entry> entry(new Entry());
+  entry->name     = name;
+  entry->klass    = FindSymbol(klass);
+  entry->config   = std::move(config);
+  entry->scope    = scope;
+  entry->building = false;
+
+  if(entry->klass == kNoSymbol || !detail::GetKlass(entry->klass)) {
+    detail::Fatal("instance %s is registered with unknown class %s",
+                  name,klass);
+  }
+
+  std::lock_guard<std::recursive_mutex> guard(lock_);
+  entries_[name] = std::move(entry);
+}
+
+void Container::AddInstance( const char* name ,
+                             detail::SharedRef&& instance ) {
+  std::unique_ptr<Entry> entry(new Entry());
+  entry->name     = name;
+  entry->klass    = kNoSymbol;
+  entry->scope    = kSingleton;
+  entry->instance = std::move(instance);
+  entry->building = false;
+
+  std::lock_guard<std::recursive_mutex> guard(lock_);
+  entries_[name] = std::move(entry);
+}
+
+Container::Entry* Container::Find( std::string_view name ) {
+  std::lock_guard<std::recursive_mutex> guard(lock_);
+  auto itr = entries_.find(name);
+  return itr != entries_.end() ? itr->second.get() : NULL;
+}
+
+detail::SharedRef Container::Create( Entry* entry ,
+                                     detail::BuildScope* scope ) {
+  auto &building = scope->building;
+  if(std::find(building.begin(),building.end(),entry) != building.end()) {
+    detail::Fatal("circular reference of instance %s",entry->name.c_str());
+  }
+
+  detail::BuilderStorage storage;
+  auto kb = detail::NewKlassObject(entry->klass,&storage);
+  assert(kb);
+
+  building.push_back(entry);
+  detail::BuildContext context;
+  context.container = this;
+  context.scope     = scope;
+  detail::Build(kb,*entry->config,&context);
+  building.pop_back();
+
+  return kb->GetShared();
+}
+
+detail::SharedRef Container::Resolve( Entry* entry ,
+                                      detail::BuildScope* scope ) {
+  switch(entry->scope) {
+    case kSingleton: {
+      std::lock_guard<std::recursive_mutex> guard(lock_);
+      if(!entry->instance.ptr) {
+        if(entry->building) {
+          detail::Fatal("circular reference of instance %s",
+                        entry->name.c_str());
+        }
+        // dependencies of a singleton live in its own scope
+        detail::BuildScope own;
+        entry->building = true;
+        entry->instance = Create(entry,&own);
+        entry->building = false;
+      }
+      return entry->instance;
+    }
+
+    case kPerBuild: {
+      auto itr = scope->instances.find(entry);
+      if(itr != scope->instances.end()) return itr->second;
+      auto instance = Create(entry,scope);
+      scope->instances[entry] = instance;
+      return instance;
+    }
+
+    default:
+      return Create(entry,scope);
+  }
+}
+
+namespace detail {
+
+SharedRef ResolveReference( Container* container , std::string_view name ,
+                                                   BuildScope* scope ) {
+  auto entry = container->Find(name);
+  if(!entry) {
+    Fatal("instance %.*s is not registered in container",
+          static_cast<int>(name.size()),name.data());
+  }
+
+  if(scope) return container->Resolve(entry,scope);
+
+  BuildScope own;
+  return container->Resolve(entry,&own);
+}
+
+} // namespace detail
+} // namespace dinject
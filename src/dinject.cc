@@ -1,4 +1,6 @@
 #include "dinject.h"
+#include "executor.h"
+#include "result.h"
 
 #include <cassert>
 #include <map>
@@ -9,18 +11,12 @@
 namespace dinject {
 namespace detail {
 
-namespace {
-
-bool BuildPrimitive( KlassBuilder* builder , const char* name ,
-                                             const ConfigValue& config ) {
-  detail::Value val;
-
+bool ConvertPrimitive( const ConfigValue& config , Value* output ) {
   switch(config.index()) {
 
 #define DO(TYPE,type)                      \
   case TYPE:                               \
-    val = std::get<type>(config);          \
-    builder->Build(name,std::move(val));   \
+    *output = std::get<type>(config);      \
     return true
 
     DO(0,bool);
@@ -33,45 +29,302 @@ bool BuildPrimitive( KlassBuilder* builder , const char* name ,
   default: return false;
   }
 }
-} // namespace
 
-void Build( KlassBuilder* builder , const ConfigObject& config ) {
-  for( auto itr(config.NewIterator()); itr->HasNext() ; itr->Next() ) {
-    std::string key;
-    ConfigValue val;
-    itr->Get(&key,&val);
-    if(!BuildPrimitive(builder,key.c_str(),val)) {
-
-      auto obj = std::get<std::shared_ptr<ConfigObject>>(val);
-      auto attr= builder->klass()->FindAttribute(key.c_str());
-
-      if(attr) {
-        if(attr->type() == kTypeObject) {
-          // object type construction
-          auto sub = detail::NewKlassObject(attr->dep());
-          if(sub) {
-            Build(sub.get(),*obj);
-            auto holder = sub->GetAny();
-            detail::Value wrapper(holder);
-            builder->Build(attr,std::move(wrapper));
-          }
+namespace {
+
+// A nested object attribute which is built by its own task in parallel build
+struct ObjectJob {
+  Attribute* attr;
+  const ConfigObject* config;
+  ObjectRef result;
+};
+
+// Name of the type of a config value , used in errors
+const char* GetConfigValueTypeName( const ConfigValue& val ) {
+  static const char* const kName[] = {
+    "bool" , "int64" , "double" , "string" , "object"
+  };
+  return kName[val.index()];
+}
+
+// Object attribute which can be built independently , the order must be
+// the same as the one BuildVisitor consumes the ObjectJob
+inline const ConfigObject* GetObjectConfig( Attribute* attr ,
+                                            const ConfigValue& val ) {
+  if(!attr || attr->type() != kTypeObject) return NULL;
+  auto obj = std::get_if<std::shared_ptr<ConfigObject>>(&val);
+  return obj ? obj->get() : NULL;
+}
+
+class ObjectCollector : public ConfigObject::Visitor {
+ public:
+  ObjectCollector( KlassBuilder* builder , std::vector<ObjectJob>* jobs ):
+    builder_(builder), jobs_(jobs)
+  {}
+
+  virtual void Visit( std::string_view key , Symbol symbol ,
+                                             const ConfigValue& val ) {
+    auto attr = Resolve(key,symbol);
+    auto obj  = GetObjectConfig(attr,val);
+    if(obj) jobs_->push_back(ObjectJob{attr,obj,ObjectRef()});
+  }
+
+  virtual void VisitString( std::string_view , Symbol , std::string_view ) {}
+
+  virtual bool Wants( std::string_view key , Symbol symbol ) {
+    auto attr = wanted_.Set(key,symbol,Find(key,symbol));
+    return attr && attr->type() == kTypeObject;
+  }
+
+ private:
+  Attribute* Find( std::string_view key , Symbol symbol ) const {
+    return symbol != kNoSymbol ? builder_->FindAttribute(symbol) :
+                                 builder_->FindAttribute(key);
+  }
+
+  Attribute* Resolve( std::string_view key , Symbol symbol ) {
+    Attribute* attr;
+    return wanted_.Take(key,symbol,&attr) ? attr : Find(key,symbol);
+  }
+
+  KlassBuilder* builder_;
+  std::vector<ObjectJob>* jobs_;
+  WantedAttribute wanted_;
+};
+
+class BuildVisitor : public ConfigObject::Visitor {
+ public:
+  BuildVisitor( KlassBuilder* builder , BuildContext* context ):
+    builder_(builder), context_(context), jobs_(NULL), next_job_(0)
+  {}
+
+  // Object attributes take their result from the already built jobs
+  BuildVisitor( KlassBuilder* builder , BuildContext* context ,
+                                        std::vector<ObjectJob>* jobs ):
+    builder_(builder), context_(context), jobs_(jobs), next_job_(0)
+  {}
+
+  virtual void Visit( std::string_view key , Symbol symbol ,
+                                             const ConfigValue& val ) {
+    if(context_->failed) return;
+    auto attr = Resolve(key,symbol);
+    if(!attr) return;
+
+    if(auto str = std::get_if<std::string>(&val)) {
+      if(BuildReference(attr,*str)) return;
+    }
+
+    detail::Value primitive;
+    if(ConvertPrimitive(val,&primitive)) {
+      if(attr->type() == kTypeStruct ||
+         !builder_->Build(attr,std::move(primitive))) {
+        Mismatch(attr,GetConfigValueTypeName(val));
+      }
+      return;
+    }
+
+    auto &obj = *std::get_if<std::shared_ptr<ConfigObject>>(&val);
+
+    if(attr->type() == kTypeObject && jobs_) {
+      // object built by parallel job
+      assert(next_job_ < jobs_->size());
+      auto &job = (*jobs_)[next_job_++];
+      assert(job.attr == attr);
+      if(job.result.ptr && !builder_->Build(attr,detail::Value(job.result)))
+        Mismatch(attr,"object");
+    } else if(attr->type() == kTypeObject) {
+      DINJECT_TRACE_SPAN(Object,attr->symbol());
+      detail::Value memo;
+      if(context_->memo && BuildMemo(attr,*obj,context_,&memo)) {
+        if(context_->failed) {
+          Nested(attr);
+        } else if(!builder_->Build(attr,memo)) {
+          // a copy which the setter rejected is still owned by us
+          if(auto ref = std::get_if<ObjectRef>(&memo))
+            GetKlass(attr->dep_symbol())->Destroy(*ref);
+          Mismatch(attr,"object");
+        }
+        return;
+      }
+      // object type construction , the object of a shared attribute is
+      // freed by its std::shared_ptr so it is never placed in the arena
+      BuilderStorage storage;
+      auto sub = context_->arena && !attr->is_shared() ?
+        detail::NewKlassObject(attr->dep_symbol(),context_->arena,&storage) :
+        detail::NewKlassObject(attr->dep_symbol(),&storage);
+      if(sub) {
+        Build(sub,*obj,context_);
+        if(context_->failed) {
+          Nested(attr);
+          return;
+        }
+        // released only once the setter takes it , otherwise the object is
+        // destroyed with the builder
+        if(builder_->Build(attr,detail::Value(sub->PeekRef()))) {
+          sub->GetRef();
         } else {
-          // struct type construction
-          assert(attr->type() == kTypeStruct);
-          auto sub = builder->BuildStruct(attr);
-          if(sub) {
-            Build(sub.get(),*obj);
-          }
+          Mismatch(attr,"object");
         }
       }
+    } else if(attr->type() == kTypeStruct) {
+      // struct type construction
+      DINJECT_TRACE_SPAN(Struct,attr->symbol());
+      BuilderStorage storage;
+      auto sub = builder_->BuildStruct(attr,&storage);
+      if(sub) {
+        Build(sub,*obj,context_);
+        if(context_->failed) Nested(attr);
+      }
+    } else {
+      Mismatch(attr,"object");
+    }
+  }
+
+  virtual void VisitString( std::string_view key , Symbol symbol ,
+                                                   std::string_view val ) {
+    if(context_->failed) return;
+    auto attr = Resolve(key,symbol);
+    if(!attr) return;
+    if(BuildReference(attr,val)) return;
+    if(attr->type() == kTypeStruct ||
+       !builder_->Build(attr,detail::Value(std::string(val)))) {
+      Mismatch(attr,"string");
     }
   }
+
+  virtual bool Wants( std::string_view key , Symbol symbol ) {
+    if(context_->failed) return false;
+    return wanted_.Set(key,symbol,Find(key,symbol)) != NULL;
+  }
+
+ private:
+  Attribute* Find( std::string_view key , Symbol symbol ) const {
+    return symbol != kNoSymbol ? builder_->FindAttribute(symbol) :
+                                 builder_->FindAttribute(key);
+  }
+
+  // Attribute of the key , reuses the one resolved by Wants
+  Attribute* Resolve( std::string_view key , Symbol symbol ) {
+    Attribute* attr;
+    return wanted_.Take(key,symbol,&attr) ? attr : Find(key,symbol);
+  }
+
+  // A string "@name" of an object attribute refers to a named instance of
+  // the container
+  bool BuildReference( Attribute* attr , std::string_view val ) {
+    if(attr->type() != kTypeObject || !context_->container) return false;
+    if(val.empty() || val.front() != '@') return false;
+    if(!builder_->Build(attr,detail::Value(
+          ResolveReference(context_->container,val.substr(1),
+                                               context_->scope)))) {
+      Mismatch(attr,"object");
+    }
+    return true;
+  }
+
+  // Report the value which doesn't match the type of the attribute , the
+  // build stops if the context has an error sink otherwise it aborts
+  void Mismatch( Attribute* attr , const char* actual ) {
+    auto error = context_->error;
+    if(!error) TypeMismatch(builder_->klass(),attr);
+    context_->failed = true;
+    error->code     = BuildError::kTypeMismatch;
+    error->klass    = builder_->klass()->name();
+    error->path     = attr->name();
+    error->expected = attr->type_name();
+    error->actual   = actual;
+  }
+
+  // The nested object or struct of the attribute failed
+  void Nested( Attribute* attr ) {
+    auto error = context_->error;
+    error->path = std::string(attr->name()) + "." + error->path;
+  }
+
+  KlassBuilder* builder_;
+  BuildContext* context_;
+  std::vector<ObjectJob>* jobs_;
+  std::size_t next_job_;
+  WantedAttribute wanted_;
+};
+
+void BuildJob( ObjectJob* job , BuildContext* context ) {
+  DINJECT_TRACE_SPAN(Object,job->attr->symbol());
+  BuilderStorage storage;
+  auto sub = detail::NewKlassObject(job->attr->dep_symbol(),&storage);
+  if(sub) {
+    Build(sub,*job->config,context);
+    job->result = sub->GetRef();
+  }
+}
+
+// Build all nested object attributes of the config in parallel , then
+// apply all attributes serially in the config order so the setters of the
+// parent are invoked in a deterministic order
+void BuildParallel( KlassBuilder* builder , const ConfigObject& config ,
+                                            BuildContext* context ) {
+  std::vector<ObjectJob> jobs;
+  {
+    ObjectCollector collector(builder,&jobs);
+    config.ForEach(&collector);
+  }
+
+  if(!jobs.empty()) {
+    TaskGroup group(context->executor);
+    for( std::size_t i = 1 ; i < jobs.size() ; ++i ) {
+      auto job = &jobs[i];
+      group.Run([job,context]() { BuildJob(job,context); });
+    }
+    // the first one is built by the current thread
+    BuildJob(&jobs.front(),context);
+    group.Wait();
+  }
+
+  BuildVisitor visitor(builder,context,&jobs);
+  config.ForEach(&visitor);
+}
+
+} // namespace
+
+void Build( KlassBuilder* builder , const ConfigObject& config ,
+                                    BuildContext* context ) {
+  DINJECT_PROFILE_BUILD(builder->klass());
+  DINJECT_TRACE_SPAN(New,builder->klass()->symbol());
+  if(context->executor) {
+    BuildParallel(builder,config,context);
+    return;
+  }
+  BuildVisitor visitor(builder,context);
+  config.ForEach(&visitor);
+}
+
+void Build( KlassBuilder* builder , const ConfigObject& config ) {
+  BuildContext context;
+  Build(builder,config,&context);
 }
 
 } // namespace detail
 
+void ConfigObject::ForEach( Visitor* visitor ) const {
+  for( auto itr(NewIterator()); itr->HasNext() ; itr->Next() ) {
+    std::string key;
+    ConfigValue val;
+    itr->Get(&key,&val);
+    visitor->Visit(key,itr->GetSymbol(),val);
+  }
+}
+
 namespace {
-typedef std::map<std::string,ConfigValue> STLConfigMap;
+struct STLConfigEntry {
+  ConfigValue value;
+  // Symbol of the key when it is already interned , e.g. the name of a
+  // registered attribute. The key itself is never interned , FindSymbol
+  // leaves an unknown key as kNoSymbol and it is resolved by name
+  Symbol symbol;
+};
+
+// std::less<> makes lookup by const char* not create a temporary std::string
+typedef std::map<std::string,STLConfigEntry,std::less<>> STLConfigMap;
 
 class STLConfigObjectIterator : public ConfigObject::Iterator {
  public:
@@ -87,7 +340,12 @@ class STLConfigObjectIterator : public ConfigObject::Iterator {
   virtual void Get( std::string* key , ConfigValue* output ) {
     assert(HasNext());
     *key = itr_->first;
-    *output= itr_->second;
+    *output= itr_->second.value;
+  }
+
+  virtual Symbol GetSymbol() const {
+    assert(HasNext());
+    return itr_->second.symbol;
   }
 
   STLConfigObjectIterator( STLConfigMap::const_iterator start ,
@@ -105,16 +363,22 @@ class STLConfigObject : public ConfigObject {
  public:
   virtual const ConfigValue* Get( const char* name ) const {
     auto itr = map_.find(name);
-    return itr != map_.end() ? &(itr->second) : NULL;
+    return itr != map_.end() ? &(itr->second.value) : NULL;
   }
   virtual const ConfigValue* Get( const std::string& name ) const {
-    return Get(name.c_str());
+    auto itr = map_.find(name);
+    return itr != map_.end() ? &(itr->second.value) : NULL;
   }
   virtual void Set( const char* name , const ConfigValue& value ) {
-    map_[name] = value;
+    Set(std::string(name),value);
   }
   virtual void Set( const std::string& name , const ConfigValue& value ) {
-    map_[name] = value;
+    auto itr = map_.find(name);
+    if(itr == map_.end()) {
+      map_.emplace(name,STLConfigEntry{value,FindSymbol(name)});
+    } else {
+      itr->second.value = value;
+    }
   }
 
   virtual std::unique_ptr<Iterator> NewIterator() const {
@@ -122,6 +386,12 @@ class STLConfigObject : public ConfigObject {
         new STLConfigObjectIterator(map_.begin(),map_.end()));
   }
 
+  virtual void ForEach( Visitor* visitor ) const {
+    for( auto &e : map_ ) {
+      visitor->Visit(e.first,e.second.symbol,e.second.value);
+    }
+  }
+
   virtual ~STLConfigObject() {}
 
  private:
@@ -0,0 +1,116 @@
+#include "executor.h"
+
+namespace dinject {
+
+namespace {
+
+// Pool and worker index of the calling thread
+thread_local const ThreadPool* kCurrentPool = NULL;
+thread_local std::size_t kCurrentIndex = 0;
+
+} // namespace
+
+ThreadPool::ThreadPool( std::size_t thread ):
+  queues_(),
+  workers_(),
+  sleep_lock_(),
+  wakeup_(),
+  pending_(0),
+  stop_(false)
+{
+  if(thread == 0) {
+    auto hc = std::thread::hardware_concurrency();
+    thread = hc > 1 ? hc - 1 : 0;
+  }
+
+  for( std::size_t i = 0 ; i <= thread ; ++i ) {
+    queues_.emplace_back(new Queue());
+  }
+  for( std::size_t i = 0 ; i < thread ; ++i ) {
+    workers_.emplace_back([this,i]() { Work(i); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> guard(sleep_lock_);
+    stop_ = true;
+  }
+  wakeup_.notify_all();
+  for( auto &e : workers_ ) e.join();
+}
+
+std::size_t ThreadPool::QueueIndex() const {
+  return kCurrentPool == this ? kCurrentIndex : queues_.size() - 1;
+}
+
+void ThreadPool::Submit( Task task ) {
+  // count the task before it is visible , so pending_ never underflows
+  {
+    std::lock_guard<std::mutex> guard(sleep_lock_);
+    ++pending_;
+  }
+  {
+    auto &q = *queues_[QueueIndex()];
+    std::lock_guard<std::mutex> guard(q.lock);
+    q.tasks.push_back(std::move(task));
+  }
+  wakeup_.notify_one();
+}
+
+bool ThreadPool::Pop( std::size_t index , Task* task ) {
+  auto &q = *queues_[index];
+  std::lock_guard<std::mutex> guard(q.lock);
+  if(q.tasks.empty()) return false;
+  *task = std::move(q.tasks.back());
+  q.tasks.pop_back();
+  return true;
+}
+
+bool ThreadPool::Steal( std::size_t index , Task* task ) {
+  for( std::size_t i = 1 ; i < queues_.size() ; ++i ) {
+    auto &q = *queues_[(index + i) % queues_.size()];
+    std::lock_guard<std::mutex> guard(q.lock);
+    if(q.tasks.empty()) continue;
+    *task = std::move(q.tasks.front());
+    q.tasks.pop_front();
+    return true;
+  }
+  return false;
+}
+
+bool ThreadPool::RunOne() {
+  auto index = QueueIndex();
+  Task task;
+  if(!Pop(index,&task) && !Steal(index,&task)) return false;
+  --pending_;
+  task();
+  return true;
+}
+
+void ThreadPool::Work( std::size_t index ) {
+  kCurrentPool  = this;
+  kCurrentIndex = index;
+
+  while(!stop_) {
+    if(RunOne()) continue;
+    std::unique_lock<std::mutex> lock(sleep_lock_);
+    wakeup_.wait(lock,[this]() { return stop_ || pending_ > 0; });
+  }
+}
+
+void TaskGroup::Run( Task task ) {
+  ++pending_;
+  executor_->Submit([this,task = std::move(task)]() {
+    task();
+    pending_.fetch_sub(1,std::memory_order_release);
+  });
+}
+
+void TaskGroup::Wait() {
+  while(pending_.load(std::memory_order_acquire) != 0) {
+    if(!executor_->RunOne()) std::this_thread::yield();
+  }
+}
+
+} // namespace dinject
@@ -0,0 +1,229 @@
+#include "flat.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <numeric>
+
+namespace dinject {
+
+class FlatConfigObjectIterator : public ConfigObject::Iterator {
+ public:
+  explicit FlatConfigObjectIterator( const FlatConfigObject* object ):
+    object_(object), index_(0)
+  {}
+
+  virtual bool HasNext() const { return index_ < object_->size(); }
+
+  virtual bool Next() {
+    ++index_;
+    return HasNext();
+  }
+
+  virtual void Get( std::string* key , ConfigValue* output ) {
+    assert(HasNext());
+    *key    = object_->key(index_);
+    *output = object_->values_[index_];
+  }
+
+  virtual Symbol GetSymbol() const {
+    assert(HasNext());
+    return object_->symbols_[index_];
+  }
+
+ private:
+  const FlatConfigObject* object_;
+  std::size_t index_;
+};
+
+FlatConfigObject::FlatConfigObject():
+  keys_(),
+  symbols_(),
+  values_(),
+  pool_(),
+  index_(),
+  sealed_(true)
+{}
+
+FlatConfigObject::Key FlatConfigObject::NewKey( std::string_view key ) {
+  Key k;
+  k.size = static_cast<std::uint32_t>(key.size());
+  k.hash = detail::HashName(key);
+  if(key.size() <= kInlineKey) {
+    std::memcpy(k.data,key.data(),key.size());
+  } else {
+    k.offset = pool_.size();
+    pool_.append(key);
+  }
+  return k;
+}
+
+void FlatConfigObject::CheckSealed() const {
+  if(!sealed_) detail::Fatal("FlatConfigObject is read before Seal");
+}
+
+void FlatConfigObject::Reserve( std::size_t count ) {
+  keys_.reserve(count);
+  symbols_.reserve(count);
+  values_.reserve(count);
+}
+
+void FlatConfigObject::Append( std::string_view key ,
+                               const ConfigValue& value ) {
+  Append(key,ConfigValue(value));
+}
+
+void FlatConfigObject::Append( std::string_view key , ConfigValue&& value ) {
+  keys_.push_back(NewKey(key));
+  symbols_.push_back(FindSymbol(key));
+  values_.push_back(std::move(value));
+  sealed_ = false;
+}
+
+void FlatConfigObject::Seal() {
+  if(sealed_) return;
+  sealed_ = true;
+
+  auto less = [this]( const Key& l , const Key& r ) {
+    return KeyView(l) < KeyView(r);
+  };
+
+  // Appending in key order is common , ie from a sorted source
+  bool sorted = true;
+  for( std::size_t i = 1 ; i < keys_.size() ; ++i ) {
+    if(!less(keys_[i-1],keys_[i])) {
+      sorted = false;
+      break;
+    }
+  }
+
+  if(!sorted) {
+    std::vector<std::uint32_t> order(keys_.size());
+    std::iota(order.begin(),order.end(),0);
+    std::stable_sort(order.begin(),order.end(),
+        [&]( std::uint32_t l , std::uint32_t r ) {
+          return less(keys_[l],keys_[r]);
+        });
+
+    std::vector<Key>         keys;
+    std::vector<Symbol>      symbols;
+    std::vector<ConfigValue> values;
+    keys.reserve   (order.size());
+    symbols.reserve(order.size());
+    values.reserve (order.size());
+
+    for( std::size_t i = 0 ; i < order.size() ; ++i ) {
+      // stable sort keeps duplicates in append order , keep the last one
+      if(i + 1 < order.size() && !less(keys_[order[i]],keys_[order[i+1]]))
+        continue;
+      auto e = order[i];
+      keys.push_back   (keys_[e]);
+      symbols.push_back(symbols_[e]);
+      values.push_back (std::move(values_[e]));
+    }
+
+    keys_.swap   (keys);
+    symbols_.swap(symbols);
+    values_.swap (values);
+  }
+
+  BuildIndex();
+}
+
+void FlatConfigObject::BuildIndex() {
+  index_.clear();
+  if(keys_.size() < kIndexThreshold) return;
+
+  // load factor at most 1/2
+  std::size_t slots = 1;
+  while(slots < keys_.size() * 2) slots <<= 1;
+  index_.assign(slots,0);
+
+  std::size_t mask = slots - 1;
+  for( std::size_t i = 0 ; i < keys_.size() ; ++i ) {
+    std::size_t slot = keys_[i].hash & mask;
+    while(index_[slot]) slot = (slot + 1) & mask;
+    index_[slot] = static_cast<std::uint32_t>(i + 1);
+  }
+}
+
+std::size_t FlatConfigObject::Find( std::string_view key ) const {
+  CheckSealed();
+
+  if(!index_.empty()) {
+    std::uint32_t hash = detail::HashName(key);
+    std::size_t   mask = index_.size() - 1;
+    for( std::size_t slot = hash & mask ; index_[slot] ;
+                     slot = (slot + 1) & mask ) {
+      auto &k = keys_[index_[slot]-1];
+      if(k.hash == hash && KeyView(k) == key) return index_[slot] - 1;
+    }
+    return keys_.size();
+  }
+
+  auto itr = std::lower_bound(keys_.begin(),keys_.end(),key,
+      [this]( const Key& l , std::string_view r ) {
+        return KeyView(l) < r;
+      });
+  if(itr != keys_.end() && KeyView(*itr) == key)
+    return static_cast<std::size_t>(itr - keys_.begin());
+  return keys_.size();
+}
+
+const ConfigValue* FlatConfigObject::Get( const char* name ) const {
+  auto i = Find(name);
+  return i != values_.size() ? &values_[i] : NULL;
+}
+
+const ConfigValue* FlatConfigObject::Get( const std::string& name ) const {
+  auto i = Find(name);
+  return i != values_.size() ? &values_[i] : NULL;
+}
+
+void FlatConfigObject::Set( const char* name , const ConfigValue& value ) {
+  Set(std::string(name),value);
+}
+
+void FlatConfigObject::Set( const std::string& name ,
+                            const ConfigValue& value ) {
+  Seal();
+
+  auto i = Find(name);
+  if(i != values_.size()) {
+    values_[i] = value;
+    return;
+  }
+
+  auto itr = std::lower_bound(keys_.begin(),keys_.end(),
+                              std::string_view(name),
+      [this]( const Key& l , std::string_view r ) {
+        return KeyView(l) < r;
+      });
+  auto pos = itr - keys_.begin();
+  keys_.insert   (itr,NewKey(name));
+  symbols_.insert(symbols_.begin() + pos,FindSymbol(name));
+  values_.insert (values_.begin()  + pos,value);
+
+  // entry indices after pos have shifted
+  if(!index_.empty() || keys_.size() >= kIndexThreshold) BuildIndex();
+}
+
+std::unique_ptr<ConfigObject::Iterator> FlatConfigObject::NewIterator() const {
+  CheckSealed();
+  return std::unique_ptr<Iterator>(new FlatConfigObjectIterator(this));
+}
+
+void FlatConfigObject::ForEach( Visitor* visitor ) const {
+  CheckSealed();
+  for( std::size_t i = 0 ; i < keys_.size() ; ++i ) {
+    auto key = KeyView(keys_[i]);
+    if(!visitor->Wants(key,symbols_[i])) continue;
+    visitor->Visit(key,symbols_[i],values_[i]);
+  }
+}
+
+std::shared_ptr<FlatConfigObject> NewFlatConfigObject() {
+  return std::make_shared<FlatConfigObject>();
+}
+
+} // namespace dinject
@@ -0,0 +1,668 @@
+#include "json.h"
+
+#include <charconv>
+#include <cstdarg>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace dinject {
+namespace detail {
+
+namespace {
+
+// Nesting limit , guards the recursive parser against stack overflow
+const int kMaxDepth = 512;
+
+// Size of each chunk read from a stream
+const std::size_t kChunkSize = 64 * 1024;
+
+// Pull based JSON tokenizer over a memory buffer or a stream , the stream
+// is read in chunks and tokens may span across chunks
+class JsonReader {
+ public:
+  explicit JsonReader( std::string_view json ):
+    input_(NULL), chunk_(), cur_(json.data()), end_(json.data()+json.size()),
+    line_(1), error_()
+  {}
+
+  explicit JsonReader( std::istream* input ):
+    input_(input), chunk_(kChunkSize), cur_(NULL), end_(NULL),
+    line_(1), error_()
+  {}
+
+  // Skip white spaces and return the next char without consuming it , -1
+  // at end of input
+  int Peek() {
+    for( ;; ) {
+      if(cur_ == end_ && !Refill()) return -1;
+      auto c = *cur_;
+      if(c == '\n') {
+        ++line_;
+      } else if(c != ' ' && c != '\t' && c != '\r') {
+        return static_cast<unsigned char>(c);
+      }
+      ++cur_;
+    }
+  }
+
+  // Consume the next char , -1 at end of input
+  int Get() {
+    if(cur_ == end_ && !Refill()) return -1;
+    return static_cast<unsigned char>(*cur_++);
+  }
+
+  // Skip white spaces and consume c
+  bool Expect( char c ) {
+    if(Peek() != static_cast<unsigned char>(c))
+      return Error("expect '%c'",c);
+    ++cur_;
+    return true;
+  }
+
+  // Read a string , the leading quote must not be consumed yet. The string
+  // is only validated and skipped if output is NULL
+  bool ReadString( std::string* output );
+
+  // Read a number , integer is returned as int64 and others as double
+  bool ReadNumber( Value* output );
+
+  // Read true , false or null
+  bool ReadLiteral( Value* output , bool* null );
+
+  // Skip any value
+  bool Skip( int depth );
+
+  // Skip a string , object or array by matching quotes and brackets only ,
+  // nothing inside is tokenized or validated. Memory input only
+  bool SkipSpan();
+
+  bool Error( const char* format , ... );
+
+  const std::string& error() const { return error_; }
+
+  // Current position , only meaningful for memory input
+  const char* position() const { return cur_; }
+
+ private:
+  bool Refill() {
+    if(!input_ || !*input_) return false;
+    input_->read(chunk_.data(),chunk_.size());
+    auto size = static_cast<std::size_t>(input_->gcount());
+    if(size == 0) return false;
+    cur_ = chunk_.data();
+    end_ = cur_ + size;
+    return true;
+  }
+
+  bool ReadEscape( std::string* output );
+  bool ReadHex( std::uint32_t* output );
+
+  std::istream* input_;
+  std::vector<char> chunk_;
+  const char* cur_;
+  const char* end_;
+  std::size_t line_;
+  std::string error_;
+};
+
+bool JsonReader::Error( const char* format , ... ) {
+  if(!error_.empty()) return false;  // keep the first error
+  char buf[256];
+  va_list va;
+  va_start(va,format);
+  std::vsnprintf(buf,sizeof(buf),format,va);
+  va_end(va);
+  error_ = "json error at line " + std::to_string(line_) + ": " + buf;
+  return false;
+}
+
+bool JsonReader::ReadString( std::string* output ) {
+  if(!Expect('"')) return false;
+  if(output) output->clear();
+  std::string skip; // escapes are short and stay in the inline buffer
+  for( ;; ) {
+    if(cur_ == end_ && !Refill()) return Error("unterminated string");
+
+    // copy the plain segment in one go
+    auto start = cur_;
+    while(cur_ != end_ && *cur_ != '"' && *cur_ != '\\' && *cur_ != '\n')
+      ++cur_;
+    if(output) output->append(start,cur_);
+    if(cur_ == end_) continue;
+
+    auto c = *cur_++;
+    if(c == '"') return true;
+    if(c == '\n') return Error("new line in string");
+    if(!ReadEscape(output ? output : &skip)) return false;
+    skip.clear();
+  }
+}
+
+bool JsonReader::ReadHex( std::uint32_t* output ) {
+  std::uint32_t v = 0;
+  for( int i = 0 ; i < 4 ; ++i ) {
+    auto c = Get();
+    v <<= 4;
+    if(c >= '0' && c <= '9')      v |= c - '0';
+    else if(c >= 'a' && c <= 'f') v |= c - 'a' + 10;
+    else if(c >= 'A' && c <= 'F') v |= c - 'A' + 10;
+    else return Error("invalid \\u escape");
+  }
+  *output = v;
+  return true;
+}
+
+bool JsonReader::ReadEscape( std::string* output ) {
+  switch(Get()) {
+    case '"':  output->push_back('"');  return true;
+    case '\\': output->push_back('\\'); return true;
+    case '/':  output->push_back('/');  return true;
+    case 'b':  output->push_back('\b'); return true;
+    case 'f':  output->push_back('\f'); return true;
+    case 'n':  output->push_back('\n'); return true;
+    case 'r':  output->push_back('\r'); return true;
+    case 't':  output->push_back('\t'); return true;
+    case 'u':  break;
+    default:   return Error("invalid escape");
+  }
+
+  std::uint32_t cp;
+  if(!ReadHex(&cp)) return false;
+  if(cp >= 0xd800 && cp <= 0xdbff) {
+    // surrogate pair
+    std::uint32_t low;
+    if(Get() != '\\' || Get() != 'u' || !ReadHex(&low) ||
+       low < 0xdc00 || low > 0xdfff)
+      return Error("invalid surrogate pair");
+    cp = 0x10000 + ((cp - 0xd800) << 10) + (low - 0xdc00);
+  }
+
+  // encode as utf8
+  if(cp < 0x80) {
+    output->push_back(static_cast<char>(cp));
+  } else if(cp < 0x800) {
+    output->push_back(static_cast<char>(0xc0 | (cp >> 6)));
+    output->push_back(static_cast<char>(0x80 | (cp & 0x3f)));
+  } else if(cp < 0x10000) {
+    output->push_back(static_cast<char>(0xe0 | (cp >> 12)));
+    output->push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3f)));
+    output->push_back(static_cast<char>(0x80 | (cp & 0x3f)));
+  } else {
+    output->push_back(static_cast<char>(0xf0 | (cp >> 18)));
+    output->push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3f)));
+    output->push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3f)));
+    output->push_back(static_cast<char>(0x80 | (cp & 0x3f)));
+  }
+  return true;
+}
+
+bool JsonReader::ReadNumber( Value* output ) {
+  char buf[64];
+  std::size_t size = 0;
+  bool real = false;
+
+  Peek();
+  for( ;; ) {
+    if(cur_ == end_ && !Refill()) break;
+    auto c = *cur_;
+    if(c == '.' || c == 'e' || c == 'E') {
+      real = true;
+    } else if(!(c == '-' || c == '+' || (c >= '0' && c <= '9'))) {
+      break;
+    }
+    if(size == sizeof(buf)) return Error("number is too long");
+    buf[size++] = c;
+    ++cur_;
+  }
+
+  if(!real) {
+    std::int64_t v;
+    auto r = std::from_chars(buf,buf+size,v);
+    if(r.ec == std::errc() && r.ptr == buf + size) {
+      *output = v;
+      return true;
+    }
+    if(r.ec != std::errc::result_out_of_range) return Error("invalid number");
+    // too large for int64 , fall back to double
+  }
+
+  double v;
+  auto r = std::from_chars(buf,buf+size,v);
+  if(r.ec != std::errc() || r.ptr != buf + size)
+    return Error("invalid number");
+  *output = v;
+  return true;
+}
+
+bool JsonReader::ReadLiteral( Value* output , bool* null ) {
+  const char* literal;
+  switch(Peek()) {
+    case 't': literal = "true";  *output = true;  *null = false; break;
+    case 'f': literal = "false"; *output = false; *null = false; break;
+    case 'n': literal = "null";  *null = true; break;
+    default:  return Error("unexpected character");
+  }
+  for( auto p = literal ; *p ; ++p ) {
+    if(Get() != static_cast<unsigned char>(*p))
+      return Error("invalid literal , expect %s",literal);
+  }
+  return true;
+}
+
+bool JsonReader::Skip( int depth ) {
+  if(depth > kMaxDepth) return Error("nesting is too deep");
+
+  switch(Peek()) {
+    case '"':
+      return ReadString(NULL);
+    case '{':
+    case '[':
+      {
+        bool object = Get() == '{';
+        char close  = object ? '}' : ']';
+        if(Peek() == static_cast<unsigned char>(close)) { ++cur_; return true; }
+        for( ;; ) {
+          if(object) {
+            if(!ReadString(NULL) || !Expect(':')) return false;
+          }
+          if(!Skip(depth+1)) return false;
+          auto c = Peek();
+          if(c == ',') { ++cur_; continue; }
+          return Expect(close);
+        }
+      }
+    case 't':
+    case 'f':
+    case 'n':
+      {
+        Value dummy;
+        bool null;
+        return ReadLiteral(&dummy,&null);
+      }
+    case -1:
+      return Error("unexpected end of input");
+    default:
+      {
+        Value dummy;
+        return ReadNumber(&dummy);
+      }
+  }
+}
+
+bool JsonReader::SkipSpan() {
+  assert(!input_);
+  std::string closing;   // brackets still open , innermost last
+  Peek();
+  do {
+    if(cur_ == end_) return Error("unexpected end of input");
+    auto c = *cur_++;
+    switch(c) {
+      case '"':
+        for( ;; ) {
+          if(cur_ == end_) return Error("unterminated string");
+          auto s = *cur_++;
+          if(s == '"') break;
+          if(s == '\\' && cur_ != end_) ++cur_;
+          else if(s == '\n') return Error("new line in string");
+        }
+        break;
+      case '{':
+      case '[':
+        if(closing.size() == static_cast<std::size_t>(kMaxDepth))
+          return Error("nesting is too deep");
+        closing.push_back(c == '{' ? '}' : ']');
+        break;
+      case '}':
+      case ']':
+        if(closing.empty() || closing.back() != c)
+          return Error("unexpected '%c'",c);
+        closing.pop_back();
+        break;
+      case '\n':
+        ++line_;
+        break;
+    }
+  } while(!closing.empty());
+  return true;
+}
+
+// Drive the builders with tokens from the reader
+class JsonBuilder {
+ public:
+  explicit JsonBuilder( JsonReader* reader ) :
+    reader_(reader), key_(), string_()
+  {}
+
+  // Build the object whose '{' is the next token
+  bool BuildObject( KlassBuilder* builder , int depth );
+
+ private:
+  bool BuildValue( KlassBuilder* builder , Attribute* attr , int depth );
+
+  void Mismatch( KlassBuilder* builder , Attribute* attr ) {
+    TypeMismatch(builder->klass(),attr);
+  }
+
+  JsonReader* reader_;
+
+  // scratch reused for all keys and strings
+  std::string key_;
+  std::string string_;
+};
+
+bool JsonBuilder::BuildObject( KlassBuilder* builder , int depth ) {
+  if(depth > kMaxDepth) return reader_->Error("nesting is too deep");
+  if(!reader_->Expect('{')) return false;
+  if(reader_->Peek() == '}') return reader_->Expect('}');
+
+  for( ;; ) {
+    if(!reader_->ReadString(&key_) || !reader_->Expect(':')) return false;
+
+    auto attr = builder->FindAttribute(std::string_view(key_));
+    if(attr) {
+      if(!BuildValue(builder,attr,depth)) return false;
+    } else {
+      if(!reader_->Skip(depth+1)) return false;
+    }
+
+    if(reader_->Peek() == ',') {
+      reader_->Get();
+      continue;
+    }
+    return reader_->Expect('}');
+  }
+}
+
+bool JsonBuilder::BuildValue( KlassBuilder* builder , Attribute* attr ,
+                                                      int depth ) {
+  switch(reader_->Peek()) {
+    case '{':
+      if(attr->type() == kTypeObject) {
+        BuilderStorage storage;
+        auto sub = NewKlassObject(attr->dep_symbol(),&storage);
+        if(!sub) return reader_->Skip(depth+1);
+        if(!BuildObject(sub,depth+1)) return false;
+        if(!builder->Build(attr,Value(sub->GetRef()))) Mismatch(builder,attr);
+        return true;
+      } else if(attr->type() == kTypeStruct) {
+        BuilderStorage storage;
+        auto sub = builder->BuildStruct(attr,&storage);
+        if(!sub) return reader_->Skip(depth+1);
+        return BuildObject(sub,depth+1);
+      }
+      Mismatch(builder,attr);
+      return false;
+    case '[':
+      // no attribute type maps to an array
+      return reader_->Skip(depth+1);
+    case '"':
+      {
+        if(!reader_->ReadString(&string_)) return false;
+        if(attr->type() == kTypeStruct ||
+           !builder->Build(attr,Value(std::move(string_)))) {
+          Mismatch(builder,attr);
+        }
+        return true;
+      }
+    case -1:
+      return reader_->Error("unexpected end of input");
+    default:
+      {
+        Value value;
+        bool null = false;
+        auto c = reader_->Peek();
+        bool ok = (c == 't' || c == 'f' || c == 'n') ?
+          reader_->ReadLiteral(&value,&null) : reader_->ReadNumber(&value);
+        if(!ok) return false;
+        if(null) return true;
+        if(attr->type() == kTypeStruct ||
+           !builder->Build(attr,std::move(value))) {
+          Mismatch(builder,attr);
+        }
+        return true;
+      }
+  }
+}
+
+bool BuildJson( KlassBuilder* builder , JsonReader* reader ,
+                                        std::string* error ) {
+  JsonBuilder json(reader);
+  bool ok = json.BuildObject(builder,0);
+  if(ok && reader->Peek() != -1) ok = reader->Error("trailing characters");
+  if(!ok && error) *error = reader->error();
+  return ok;
+}
+
+// A JSON object whose entries are indexed on first access , nested objects
+// and strings are only parsed when they are reached. The text is shared by
+// all objects of the document. Indexing an object tokenizes its own keys
+// and scalars only , a nested object , array or string is skipped over by
+// matching its brackets and quotes so it is lexed once when it is reached
+class LazyJsonObject : public ConfigObject {
+ public:
+  LazyJsonObject( const std::shared_ptr<const std::string>& text ,
+                  const char* begin , const char* end ):
+    text_(text), begin_(begin), end_(end), indexed_(), lock_(), entries_(),
+    index_()
+  {}
+
+  virtual const ConfigValue* Get( const char* name ) const {
+    return Find(name);
+  }
+  virtual const ConfigValue* Get( const std::string& name ) const {
+    return Find(name);
+  }
+
+  virtual void Set( const char* name , const ConfigValue& value ) {
+    Set(std::string(name),value);
+  }
+  virtual void Set( const std::string& name , const ConfigValue& value );
+
+  virtual std::unique_ptr<Iterator> NewIterator() const;
+
+  virtual void ForEach( Visitor* visitor ) const {
+    Index();
+    for( auto &e : entries_ ) {
+      if(!visitor->Wants(e.key,e.symbol)) continue;
+      visitor->Visit(e.key,e.symbol,Materialize(&e));
+    }
+  }
+
+  struct Entry {
+    std::string key;
+    Symbol symbol;
+    const char* begin;    // text of the value , parsed on demand
+    const char* end;
+    bool ready;
+    ConfigValue value;
+  };
+
+  // Index the entries on first call , returns false and sets error on
+  // syntax error. Without error a syntax error is fatal , which happens
+  // when a nested object of a broken document is reached
+  bool Index( std::string* error = NULL ) const;
+  const ConfigValue& Materialize( Entry* entry ) const;
+
+ private:
+  const ConfigValue* Find( std::string_view name ) const {
+    Index();
+    auto itr = index_.find(name);
+    return itr == index_.end() ? NULL : &Materialize(itr->second);
+  }
+
+  bool BuildIndex( std::string* error ) const;
+
+  std::shared_ptr<const std::string> text_;
+  const char* begin_;
+  const char* end_;
+
+  mutable std::once_flag indexed_;
+  mutable std::mutex lock_;
+
+  // deque keeps the entries and their keys at stable address
+  mutable std::deque<Entry> entries_;
+  mutable std::unordered_map<std::string_view,Entry*> index_;
+};
+
+bool LazyJsonObject::Index( std::string* error ) const {
+  bool ok = true;
+  std::string message;
+  std::call_once(indexed_,[&]() { ok = BuildIndex(&message); });
+  if(ok) return true;
+  if(!error) Fatal("%s",message.c_str());
+  *error = std::move(message);
+  return false;
+}
+
+bool LazyJsonObject::BuildIndex( std::string* error ) const {
+  JsonReader reader(std::string_view(begin_,end_-begin_));
+  bool ok = reader.Expect('{');
+  bool empty = ok && reader.Peek() == '}';
+
+  while(ok && !empty) {
+    Entry e;
+    ok = reader.ReadString(&e.key) && reader.Expect(':');
+    if(!ok) break;
+    e.symbol = FindSymbol(e.key);
+    e.ready  = false;
+
+    auto c  = reader.Peek();
+    e.begin = reader.position();
+    bool keep = true;
+    if(c == '{' || c == '"') {
+      ok = reader.SkipSpan();
+    } else if(c == '[') {
+      ok = reader.SkipSpan();
+      keep = false;         // array has no ConfigValue
+    } else if(c == 't' || c == 'f' || c == 'n') {
+      Value v;
+      bool null;
+      ok = reader.ReadLiteral(&v,&null);
+      keep = ok && !null;
+      if(keep) e.value = std::get<bool>(v);
+      e.ready = true;
+    } else {
+      Value v;
+      ok = reader.ReadNumber(&v);
+      if(auto i = std::get_if<std::int64_t>(&v)) e.value = *i;
+      else if(ok) e.value = std::get<double>(v);
+      e.ready = true;
+    }
+    e.end = reader.position();
+
+    if(ok && keep) {
+      entries_.push_back(std::move(e));
+      auto &entry = entries_.back();
+      index_[entry.key] = &entry;   // the last one wins like Set
+    }
+    if(!ok || reader.Peek() != ',') break;
+    reader.Get();
+  }
+
+  ok = ok && reader.Expect('}');
+  if(ok && reader.Peek() != -1) ok = reader.Error("trailing characters");
+  if(!ok && error) *error = reader.error();
+  return ok;
+}
+
+const ConfigValue& LazyJsonObject::Materialize( Entry* entry ) const {
+  std::lock_guard<std::mutex> guard(lock_);
+  if(!entry->ready) {
+    if(*entry->begin == '{') {
+      entry->value = std::shared_ptr<ConfigObject>(
+          new LazyJsonObject(text_,entry->begin,entry->end));
+    } else {
+      JsonReader reader(std::string_view(entry->begin,
+                                         entry->end-entry->begin));
+      std::string value;
+      if(!reader.ReadString(&value)) Fatal("%s",reader.error().c_str());
+      entry->value = std::move(value);
+    }
+    entry->ready = true;
+  }
+  return entry->value;
+}
+
+void LazyJsonObject::Set( const std::string& name , const ConfigValue& value ) {
+  Index();
+  std::lock_guard<std::mutex> guard(lock_);
+  auto itr = index_.find(name);
+  if(itr != index_.end()) {
+    itr->second->value = value;
+    itr->second->ready = true;
+    return;
+  }
+  entries_.push_back(Entry{name,FindSymbol(name),NULL,NULL,true,value});
+  auto &entry = entries_.back();
+  index_[entry.key] = &entry;
+}
+
+class LazyJsonIterator : public ConfigObject::Iterator {
+ public:
+  explicit LazyJsonIterator( const LazyJsonObject* object ,
+                             std::deque<LazyJsonObject::Entry>* entries ):
+    object_(object), entries_(entries), index_(0)
+  {}
+
+  virtual bool HasNext() const { return index_ < entries_->size(); }
+
+  virtual bool Next() {
+    ++index_;
+    return HasNext();
+  }
+
+  virtual void Get( std::string* key , ConfigValue* output ) {
+    assert(HasNext());
+    auto &e = (*entries_)[index_];
+    *key    = e.key;
+    *output = object_->Materialize(&e);
+  }
+
+  virtual Symbol GetSymbol() const {
+    assert(HasNext());
+    return (*entries_)[index_].symbol;
+  }
+
+ private:
+  const LazyJsonObject* object_;
+  std::deque<LazyJsonObject::Entry>* entries_;
+  std::size_t index_;
+};
+
+std::unique_ptr<ConfigObject::Iterator> LazyJsonObject::NewIterator() const {
+  Index();
+  return std::unique_ptr<Iterator>(new LazyJsonIterator(this,&entries_));
+}
+
+} // namespace
+
+bool BuildJson( KlassBuilder* builder , std::string_view json ,
+                                        std::string* error ) {
+  JsonReader reader(json);
+  return BuildJson(builder,&reader,error);
+}
+
+bool BuildJson( KlassBuilder* builder , std::istream& input ,
+                                        std::string* error ) {
+  JsonReader reader(&input);
+  return BuildJson(builder,&reader,error);
+}
+
+} // namespace detail
+
+std::shared_ptr<ConfigObject> NewLazyJsonConfigObject( std::string text ,
+                                                       std::string* error ) {
+  auto shared = std::make_shared<const std::string>(std::move(text));
+  auto root   = std::make_shared<detail::LazyJsonObject>(shared,
+      shared->data(),shared->data()+shared->size());
+
+  // only the top level is checked here , a nested value is checked when
+  // it is reached
+  if(!root->Index(error)) return std::shared_ptr<ConfigObject>();
+  return root;
+}
+
+} // namespace dinject
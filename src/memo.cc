@@ -0,0 +1,179 @@
+#include "memo.h"
+
+#include <cstring>
+#include <functional>
+#include <string_view>
+
+namespace dinject {
+
+namespace {
+
+// Serialize a config tree into a flat key , each entry is
+//
+//   '\1' key-size key type payload
+//
+// and an object ends with '\0'. Primitives are stored in native byte order
+class KeyWriter : public ConfigObject::Visitor {
+ public:
+  explicit KeyWriter( std::string* output ) : output_(output) {}
+
+  virtual void Visit( std::string_view key , Symbol ,
+                                             const ConfigValue& val ) {
+    WriteKey(key,static_cast<char>(val.index()));
+    switch(val.index()) {
+      case 0: Write(std::get<bool>(val)); break;
+      case 1: Write(std::get<std::int64_t>(val)); break;
+      case 2: Write(std::get<double>(val)); break;
+      case 3: WriteString(std::get<std::string>(val)); break;
+      default: {
+        auto &obj = std::get<std::shared_ptr<ConfigObject>>(val);
+        if(obj) obj->ForEach(this);
+        output_->push_back('\0');
+        break;
+      }
+    }
+  }
+
+  virtual void VisitString( std::string_view key , Symbol ,
+                                                   std::string_view val ) {
+    WriteKey(key,3);
+    WriteString(val);
+  }
+
+ private:
+  template< typename T > void Write( const T& value ) {
+    output_->append(reinterpret_cast<const char*>(&value),sizeof(T));
+  }
+
+  void WriteString( std::string_view value ) {
+    Write(static_cast<std::uint32_t>(value.size()));
+    output_->append(value);
+  }
+
+  void WriteKey( std::string_view key , char type ) {
+    output_->push_back('\1');
+    WriteString(key);
+    output_->push_back(type);
+  }
+
+  std::string* output_;
+};
+
+} // namespace
+
+MemoCache::MemoCache( std::size_t capacity ):
+  capacity_(capacity),
+  lock_(),
+  lru_(),
+  index_(),
+  stats_()
+{}
+
+MemoCache::~MemoCache() {}
+
+MemoCache::Stats MemoCache::stats() const {
+  std::lock_guard<std::mutex> guard(lock_);
+  return stats_;
+}
+
+void MemoCache::Clear() {
+  std::lock_guard<std::mutex> guard(lock_);
+  index_.clear();
+  lru_.clear();
+  stats_.count = 0;
+  stats_.bytes = 0;
+}
+
+detail::SharedRef MemoCache::Find( std::size_t hash , Symbol klass ,
+                                   const std::string& key ) {
+  std::lock_guard<std::mutex> guard(lock_);
+  auto range = index_.equal_range(hash);
+  for( auto itr = range.first ; itr != range.second ; ++itr ) {
+    auto entry = itr->second;
+    if(entry->klass == klass && entry->key == key) {
+      lru_.splice(lru_.begin(),lru_,entry);
+      ++stats_.hit;
+      return entry->object;
+    }
+  }
+  ++stats_.miss;
+  return detail::SharedRef();
+}
+
+void MemoCache::Add( std::size_t hash , Symbol klass , std::string&& key ,
+                     const detail::SharedRef& object ,
+                     std::size_t object_size ) {
+  std::size_t bytes = sizeof(Entry) + object_size + key.size();
+  if(bytes > capacity_) return;
+
+  std::lock_guard<std::mutex> guard(lock_);
+
+  // another thread may have built the same config at the same time
+  auto range = index_.equal_range(hash);
+  for( auto itr = range.first ; itr != range.second ; ++itr ) {
+    if(itr->second->klass == klass && itr->second->key == key) return;
+  }
+
+  lru_.push_front(Entry{hash,klass,std::move(key),object,bytes});
+  index_.emplace(hash,lru_.begin());
+  ++stats_.count;
+  stats_.bytes += bytes;
+
+  while(stats_.bytes > capacity_) Evict();
+}
+
+void MemoCache::Evict() {
+  auto entry = std::prev(lru_.end());
+  auto range = index_.equal_range(entry->hash);
+  for( auto itr = range.first ; itr != range.second ; ++itr ) {
+    if(itr->second == entry) {
+      index_.erase(itr);
+      break;
+    }
+  }
+  --stats_.count;
+  stats_.bytes -= entry->bytes;
+  ++stats_.evict;
+  lru_.erase(entry);
+}
+
+namespace detail {
+
+bool BuildMemo( Attribute* attr , const ConfigObject& config ,
+                BuildContext* context , Value* output ) {
+  auto klass = GetKlass(attr->dep_symbol());
+  if(!klass) return false;
+
+  bool share = klass->immutable() && attr->is_shared();
+  if(!share && !klass->memoizable()) return false;
+
+  std::string key;
+  {
+    KeyWriter writer(&key);
+    config.ForEach(&writer);
+  }
+  auto hash = std::hash<std::string>()(key) ^ klass->symbol();
+
+  auto memo   = context->memo;
+  auto object = memo->Find(hash,klass->symbol(),key);
+  if(!object.ptr) {
+    BuilderStorage storage;
+    auto kb = NewKlassObject(attr->dep_symbol(),&storage);
+    if(!kb) return false;
+    Build(kb,config,context);
+    if(context->failed) return true;   // nothing is cached
+    object = kb->GetShared();
+    memo->Add(hash,klass->symbol(),std::move(key),object,
+              klass->object_size());
+  }
+
+  if(share) {
+    *output = Value(std::move(object));
+  } else {
+    *output = Value(klass->Clone(object.ptr.get()));
+  }
+  return true;
+}
+
+} // namespace detail
+} // namespace dinject
@@ -1,5 +1,4 @@
 #include "meta.h"
-#include <unordered_map>
 #include <queue>
 
 namespace dinject {
@@ -14,20 +13,116 @@ const char* GetCppTypeName( CppType type ) {
 #undef __ // __
 }
 
-Attribute* KlassBuilder::FindAttribute( const char* name ) {
-  std::queue<Klass*> queue;
-  queue.push(klass_.get());
+std::size_t GetCppTypeSize( CppType type ) {
+#define __(A,B,...) case A: return sizeof(B);
+  switch(type) {
+    DINJECT_PRIMITIVE_TYPE(__)
+    default: return 0;
+  }
+#undef __ // __
+}
+
+TypeId NewTypeId() {
+  static TypeId kNextTypeId = kNoTypeId;
+  return ++kNextTypeId;
+}
+
+Attribute* KlassBuilder::FindAttribute( std::string_view name ) {
+  DINJECT_PROFILE_TIME(klass_,lookup_ns);
+  auto attr = klass_->ResolveAttribute(name);
+  if(!attr) DINJECT_PROFILE_COUNT(klass_,miss);
+  return attr;
+}
+
+Attribute* KlassBuilder::FindAttribute( Symbol symbol ) {
+  DINJECT_PROFILE_TIME(klass_,lookup_ns);
+  auto attr = klass_->ResolveAttribute(symbol);
+  if(!attr) DINJECT_PROFILE_COUNT(klass_,miss);
+  return attr;
+}
+
+namespace {
+
+// Bumped on every registration which changes a Klass , a sealed table is
+// valid as long as its epoch matches. Starts from 1 so a default constructed
+// Klass is never sealed
+std::uint64_t kKlassTableEpoch = 1;
+
+} // namespace
+
+void InvalidateKlassTable() {
+  if(IsFrozen()) Fatal("class registry is frozen , cannot modify class");
+  ++kKlassTableEpoch;
+}
+
+bool Klass::sealed() const { return table_epoch_ == kKlassTableEpoch; }
+
+void Klass::Seal() const {
+  // Collect attributes in breadth first order , the first attribute found
+  // with a name shadows the ones with same name in the parents
+  std::vector<Attribute*> flatten;
+  std::queue<const Klass*> queue;
+  queue.push(this);
 
   while(!queue.empty()) {
-    auto &cls = queue.front();
-    auto attr = cls->FindAttribute(name);
-    if(attr) return attr;
+    auto cls = queue.front();
     queue.pop();
+    for( auto &e : cls->attributes_ ) flatten.push_back(e.get());
+    for( auto &e : cls->parents() ) queue.push(e.get());
+  }
+
+  std::size_t size = 4;
+  while(size < flatten.size() * 2) size <<= 1;
 
-    auto p = cls->parents();
-    for( auto &e : p ) {
-      queue.push(e.get());
+  table_.assign(size,AttributeSlot{0,NULL});
+  symbol_table_.assign(size,SymbolSlot{kNoSymbol,NULL});
+  table_mask_ = static_cast<std::uint32_t>(size - 1);
+
+  for( auto attr : flatten ) {
+    auto idx = attr->hash() & table_mask_;
+    bool shadowed = false;
+    while(table_[idx].attr) {
+      if(table_[idx].hash == attr->hash() &&
+         strcmp(table_[idx].attr->name(),attr->name()) == 0) {
+        shadowed = true;
+        break;
+      }
+      idx = (idx + 1) & table_mask_;
     }
+    if(shadowed) continue;
+    table_[idx] = AttributeSlot{attr->hash(),attr};
+
+    // symbols are small sequential integers so they are used as the hash
+    idx = attr->symbol() & table_mask_;
+    while(symbol_table_[idx].attr) idx = (idx + 1) & table_mask_;
+    symbol_table_[idx] = SymbolSlot{attr->symbol(),attr};
+  }
+
+  table_epoch_ = kKlassTableEpoch;
+}
+
+Attribute* Klass::ResolveAttribute( std::string_view name ) const {
+  if(!sealed()) Seal();
+
+  auto hash = HashName(name);
+  auto idx  = hash & table_mask_;
+  while(table_[idx].attr) {
+    auto &slot = table_[idx];
+    if(slot.hash == hash && name == slot.attr->name())
+      return slot.attr;
+    idx = (idx + 1) & table_mask_;
+  }
+  return NULL;
+}
+
+Attribute* Klass::ResolveAttribute( Symbol symbol ) const {
+  if(!sealed()) Seal();
+
+  auto idx = symbol & table_mask_;
+  while(symbol_table_[idx].attr) {
+    if(symbol_table_[idx].symbol == symbol)
+      return symbol_table_[idx].attr;
+    idx = (idx + 1) & table_mask_;
   }
   return NULL;
 }
@@ -50,31 +145,110 @@ class MetaManager {
     return kInstance;
   }
 
-  Klass* GetKlass( const char* name ) const {
-    auto itr = sets_.find(name);
-    return (itr == sets_.end()) ? NULL : itr->second.get();
+  Klass* GetKlass( Symbol symbol ) const {
+    return symbol < sets_.size() ? sets_[symbol].get() : NULL;
   }
 
   void AddKlass( const char* name , const std::shared_ptr<Klass>& kls ) {
-    sets_[name] = kls;
+    if(IsFrozen())
+      Fatal("class registry is frozen , cannot register class %s",name);
+    auto symbol = Intern(name);
+    if(symbol >= sets_.size()) sets_.resize(symbol+1);
+    sets_[symbol] = kls;
+  }
+
+  // Seal all Klass and take a snapshot of raw pointers
+  void Freeze( std::vector<Klass*>* output ) const {
+    output->reserve(sets_.size());
+    for( auto &e : sets_ ) {
+      if(e) e->Seal();
+      output->push_back(e.get());
+    }
   }
+
  private:
   MetaManager():sets_() {}
-  std::unordered_map<std::string,std::shared_ptr<Klass>> sets_;
+
+  // Indexed by the Symbol of the class name , symbols are dense so the
+  // vector is small and lookup is a single index operation
+  std::vector<std::shared_ptr<Klass>> sets_;
 };
 
+/**
+ * Frozen registry , an immutable array of Klass indexed by Symbol. It is
+ * written once by FreezeKlass which must happen before any other thread
+ * starts to use dinject , after that it is only read so no lock or atomic
+ * operation is needed on the read path
+ */
+struct FrozenKlassTable {
+  Klass* const* klass;
+  std::size_t size;
+};
+
+FrozenKlassTable kFrozenKlassTable = { NULL , 0 };
+
+inline Klass* LookupKlass( Symbol symbol ) {
+  if(kFrozenKlassTable.klass) {
+    return symbol < kFrozenKlassTable.size ?
+      kFrozenKlassTable.klass[symbol] : NULL;
+  }
+  return MetaManager::GetInstance().GetKlass(symbol);
+}
+
 } // namespace
 
-std::unique_ptr<KlassBuilder> NewKlassObject( const char* name ) {
-  auto kls = MetaManager::GetInstance().GetKlass(name);
+bool IsFrozen() { return kFrozenKlassTable.klass != NULL; }
+
+void FreezeKlass() {
+  if(IsFrozen()) return;
+
+  static std::vector<Klass*> kSnapshot;
+  MetaManager::GetInstance().Freeze(&kSnapshot);
+  FreezeSymbolTable();
+
+  // an empty registry still needs a non NULL table to be frozen
+  if(kSnapshot.empty()) kSnapshot.push_back(NULL);
+  kFrozenKlassTable.klass = kSnapshot.data();
+  kFrozenKlassTable.size  = kSnapshot.size();
+}
+
+std::unique_ptr<KlassBuilder> NewKlassObject( Symbol symbol ) {
+  auto kls = LookupKlass(symbol);
   if(kls) {
+    DINJECT_PROFILE_COUNT(kls,count);
+    DINJECT_PROFILE_TIME(kls,alloc_ns);
     return kls->New();
   }
   return std::unique_ptr<KlassBuilder>();
 }
 
+KlassBuilder* NewKlassObject( Symbol symbol , BuilderStorage* storage ) {
+  auto kls = LookupKlass(symbol);
+  if(!kls) return NULL;
+  DINJECT_PROFILE_COUNT(kls,count);
+  DINJECT_PROFILE_TIME(kls,alloc_ns);
+  return kls->New(storage);
+}
+
+KlassBuilder* NewKlassObject( Symbol symbol , Arena* arena ,
+                                              BuilderStorage* storage ) {
+  auto kls = LookupKlass(symbol);
+  if(!kls) return NULL;
+  DINJECT_PROFILE_COUNT(kls,count);
+  DINJECT_PROFILE_TIME(kls,alloc_ns);
+  return kls->New(arena,storage);
+}
+
+std::unique_ptr<KlassBuilder> NewKlassObject( const char* name ) {
+  return NewKlassObject(FindSymbol(name));
+}
+
+Klass* GetKlass( Symbol symbol ) {
+  return LookupKlass(symbol);
+}
+
 Klass* GetKlass( const char* name ) {
-  return MetaManager::GetInstance().GetKlass(name);
+  return LookupKlass(FindSymbol(name));
 }
 
 void AddKlass( const char* name , const std::shared_ptr<Klass>& kls ) {
@@ -0,0 +1,193 @@
+#include "plan.h"
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+namespace dinject {
+
+Plan::Plan( const char* name , const ConfigObject& config ):
+  klass_(detail::GetKlass(name)),
+  code_(),
+  data_()
+{
+  if(klass_) Compile(klass_,config);
+}
+
+class Plan::Compiler : public ConfigObject::Visitor {
+ public:
+  Compiler( Plan* plan , const detail::Klass* klass ):
+    plan_(plan), klass_(klass), fields_()
+  {}
+
+  virtual void Visit( std::string_view key , Symbol symbol ,
+                                             const ConfigValue& val ) {
+    auto attr = Resolve(key,symbol);
+    if(!attr) return;
+
+    Instruction ins(kOpBuild,attr,NULL);
+    if(detail::ConvertPrimitive(val,&ins.value)) {
+      if(attr->type() == detail::kTypeStruct) {
+        detail::TypeMismatch(klass_,attr);
+      }
+      Field field;
+      if(CompileField(klass_,attr,ins.value,&field)) {
+        fields_.push_back(field);
+      } else {
+        plan_->code_.push_back(std::move(ins));
+      }
+      return;
+    }
+
+    // nested config for a primitive attribute
+    if(attr->type() != detail::kTypeObject &&
+       attr->type() != detail::kTypeStruct) {
+      detail::TypeMismatch(klass_,attr);
+    }
+
+    auto &obj = *std::get_if<std::shared_ptr<ConfigObject>>(&val);
+    auto sub  = detail::GetKlass(attr->dep_symbol());
+    if(!sub) return;
+
+    if(attr->type() == detail::kTypeObject) {
+      plan_->code_.emplace_back(kOpBeginObject,attr,sub);
+      plan_->Compile(sub,*obj);
+      plan_->code_.emplace_back(kOpEndObject,attr,sub);
+    } else {
+      plan_->code_.emplace_back(kOpBeginStruct,attr,sub);
+      plan_->Compile(sub,*obj);
+      plan_->code_.emplace_back(kOpEndStruct,attr,sub);
+    }
+  }
+
+  virtual bool Wants( std::string_view key , Symbol symbol ) {
+    return wanted_.Set(key,symbol,Find(key,symbol)) != NULL;
+  }
+
+  std::vector<Field>* fields() { return &fields_; }
+
+ private:
+  detail::Attribute* Find( std::string_view key , Symbol symbol ) const {
+    return symbol != kNoSymbol ? klass_->ResolveAttribute(symbol) :
+                                 klass_->ResolveAttribute(key);
+  }
+
+  detail::Attribute* Resolve( std::string_view key , Symbol symbol ) {
+    detail::Attribute* attr;
+    return wanted_.Take(key,symbol,&attr) ? attr : Find(key,symbol);
+  }
+
+  Plan* plan_;
+  const detail::Klass* klass_;
+  detail::WantedAttribute wanted_;
+
+  // Primitive fields of the object , they are plain data and are emitted
+  // together in front of the setters
+  std::vector<Field> fields_;
+};
+
+void Plan::Compile( const detail::Klass* klass , const ConfigObject& config ) {
+  auto pc = code_.size();
+  Compiler compiler(this,klass);
+  config.ForEach(&compiler);
+  EmitField(pc,compiler.fields());
+}
+
+bool Plan::CompileField( const detail::Klass* klass ,
+                         const detail::Attribute* attr ,
+                         const detail::Value& value , Field* output ) {
+  auto size = detail::GetCppTypeSize(attr->type());
+  if(!attr->is_field() || size == 0) return false;
+
+  // encoded into an aligned scratch and copied out as raw bytes later
+  if(!detail::StoreField(&output->bits,attr->type(),value)) {
+    detail::TypeMismatch(klass,attr);
+  }
+  output->offset = static_cast<std::size_t>(attr->offset());
+  output->size   = size;
+  return true;
+}
+
+void Plan::EmitField( std::size_t pc , std::vector<Field>* fields ) {
+  if(fields->empty()) return;
+
+  std::sort(fields->begin(),fields->end(),[]( const Field& l ,
+                                              const Field& r ) {
+    return l.offset < r.offset;
+  });
+
+  std::vector<Instruction> code;
+  for( auto &e : *fields ) {
+    auto data = data_.size();
+    data_.resize(data + e.size);
+    std::memcpy(data_.data() + data,&e.bits,e.size);
+
+    if(!code.empty() && code.back().offset + code.back().size == e.offset) {
+      code.back().size += e.size;
+      continue;
+    }
+
+    Instruction ins(kOpField,NULL,NULL);
+    ins.offset = e.offset;
+    ins.size   = e.size;
+    ins.data   = data;
+    code.push_back(std::move(ins));
+  }
+
+  code_.insert(code_.begin() + pc,std::make_move_iterator(code.begin()),
+                                  std::make_move_iterator(code.end()));
+}
+
+void Plan::Replay( detail::KlassBuilder* builder ) const {
+  auto pc = Replay(builder,0);
+  (void)pc;
+  assert(pc == code_.size());
+}
+
+std::size_t Plan::Replay( detail::KlassBuilder* builder ,
+                          std::size_t pc ) const {
+  while(pc < code_.size()) {
+    auto &ins = code_[pc];
+    switch(ins.op) {
+      case kOpBuild:
+        if(!builder->Build(ins.attr,ins.value))
+          detail::TypeMismatch(builder->klass(),ins.attr);
+        ++pc;
+        break;
+      case kOpField:
+        std::memcpy(static_cast<char*>(builder->address()) + ins.offset,
+                    data_.data() + ins.data,ins.size);
+        ++pc;
+        break;
+      case kOpBeginObject:
+        {
+          detail::BuilderStorage storage;
+          auto sub = ins.klass->New(&storage);
+          pc = Replay(sub,pc+1);
+          assert(code_[pc].op == kOpEndObject);
+          if(!builder->Build(code_[pc].attr,detail::Value(sub->GetRef())))
+            detail::TypeMismatch(builder->klass(),code_[pc].attr);
+          ++pc;
+        }
+        break;
+      case kOpBeginStruct:
+        {
+          detail::BuilderStorage storage;
+          auto sub = builder->BuildStruct(ins.attr,&storage);
+          pc = Replay(sub,pc+1);
+          assert(code_[pc].op == kOpEndStruct);
+          ++pc;
+        }
+        break;
+      default:
+        // end of the current object/struct
+        return pc;
+    }
+  }
+  return pc;
+}
+
+} // namespace dinject
@@ -0,0 +1,173 @@
+#include "profile.h"
+
+#include <algorithm>
+
+namespace dinject {
+
+#ifdef DINJECT_PROFILE
+
+namespace detail {
+namespace {
+
+// Symbols are dense , the counters are kept in chunks indexed by Symbol
+// which are allocated on first use and never freed , so a lookup is lock
+// free and the counters never move
+const std::size_t kChunkBits = 10;
+const std::size_t kChunkSize = 1 << kChunkBits;
+const std::size_t kMaxChunk  = 1024;
+
+std::atomic<KlassStats*> kChunks[kMaxChunk];
+
+// Symbols beyond the table share one set of counters
+KlassStats kOverflow;
+
+KlassStats* GetChunk( std::size_t index , bool create ) {
+  auto chunk = kChunks[index].load(std::memory_order_acquire);
+  if(chunk || !create) return chunk;
+  auto fresh = new KlassStats[kChunkSize]();
+  if(kChunks[index].compare_exchange_strong(chunk,fresh,
+                                            std::memory_order_acq_rel)) {
+    return fresh;
+  }
+  delete [] fresh;
+  return chunk;
+}
+
+template< typename T >
+std::uint64_t Load( const std::atomic<T>& v ) {
+  return v.load(std::memory_order_relaxed);
+}
+
+bool Snapshot( Symbol symbol , const KlassStats& stats ,
+                               KlassProfile* output ) {
+  if(!Load(stats.count) && !Load(stats.miss) && !Load(stats.setter_count))
+    return false;
+  auto name = GetSymbolName(symbol);
+  output->name         = name ? name : "";
+  output->count        = Load(stats.count);
+  output->build_ns     = Load(stats.build_ns);
+  output->alloc_ns     = Load(stats.alloc_ns);
+  output->lookup_ns    = Load(stats.lookup_ns);
+  output->setter_ns    = Load(stats.setter_ns);
+  output->setter_count = Load(stats.setter_count);
+  output->miss         = Load(stats.miss);
+  for( std::size_t i = 0 ; i < kProfileBuckets ; ++i )
+    output->histogram[i] = Load(stats.histogram[i]);
+  return true;
+}
+
+void Clear( KlassStats* stats ) {
+  stats->count        = 0;
+  stats->build_ns     = 0;
+  stats->alloc_ns     = 0;
+  stats->lookup_ns    = 0;
+  stats->setter_ns    = 0;
+  stats->setter_count = 0;
+  stats->miss         = 0;
+  for( auto &e : stats->histogram ) e = 0;
+}
+
+} // namespace
+
+KlassStats* GetKlassStats( Symbol klass ) {
+  auto index = klass >> kChunkBits;
+  if(index >= kMaxChunk) return &kOverflow;
+  return GetChunk(index,true) + (klass & (kChunkSize - 1));
+}
+
+} // namespace detail
+
+bool ProfileEnabled() { return true; }
+
+std::vector<KlassProfile> GetProfile() {
+  std::vector<KlassProfile> result;
+  for( std::size_t i = 0 ; i < detail::kMaxChunk ; ++i ) {
+    auto chunk = detail::GetChunk(i,false);
+    if(!chunk) continue;
+    for( std::size_t j = 0 ; j < detail::kChunkSize ; ++j ) {
+      KlassProfile profile;
+      auto symbol = static_cast<Symbol>((i << detail::kChunkBits) + j);
+      if(detail::Snapshot(symbol,chunk[j],&profile))
+        result.push_back(std::move(profile));
+    }
+  }
+  std::stable_sort(result.begin(),result.end(),
+      []( const KlassProfile& l , const KlassProfile& r ) {
+        return l.build_ns > r.build_ns;
+      });
+  return result;
+}
+
+bool GetProfile( const char* klass , KlassProfile* output ) {
+  auto symbol = FindSymbol(klass);
+  if(symbol == kNoSymbol) return false;
+  auto chunk = detail::GetChunk(symbol >> detail::kChunkBits,false);
+  if(!chunk) return false;
+  return detail::Snapshot(symbol,chunk[symbol & (detail::kChunkSize-1)],
+                          output);
+}
+
+void ResetProfile() {
+  for( std::size_t i = 0 ; i < detail::kMaxChunk ; ++i ) {
+    auto chunk = detail::GetChunk(i,false);
+    if(!chunk) continue;
+    for( std::size_t j = 0 ; j < detail::kChunkSize ; ++j )
+      detail::Clear(chunk + j);
+  }
+  detail::Clear(&detail::kOverflow);
+}
+
+#else
+
+bool ProfileEnabled() { return false; }
+
+std::vector<KlassProfile> GetProfile() {
+  return std::vector<KlassProfile>();
+}
+
+bool GetProfile( const char* , KlassProfile* ) { return false; }
+
+void ResetProfile() {}
+
+#endif // DINJECT_PROFILE
+
+std::uint64_t KlassProfile::Percentile( double q ) const {
+  std::uint64_t total = 0;
+  for( auto e : histogram ) total += e;
+  if(!total) return 0;
+
+  auto target = static_cast<std::uint64_t>(q * static_cast<double>(total));
+  if(target >= total) target = total - 1;
+
+  std::uint64_t seen = 0;
+  for( std::size_t i = 0 ; i < kProfileBuckets ; ++i ) {
+    seen += histogram[i];
+    if(seen > target) return std::uint64_t(2) << i;
+  }
+  return std::uint64_t(2) << (kProfileBuckets - 1);
+}
+
+void DumpProfile( std::FILE* output ) {
+  if(!ProfileEnabled()) {
+    std::fprintf(output,"dinject is not compiled with DINJECT_PROFILE\n");
+    return;
+  }
+  std::fprintf(output,"%-24s %10s %10s %10s %10s %10s %8s %10s %10s\n",
+               "class","count","build(us)","alloc(us)","lookup(us)",
+               "setter(us)","miss","p50(ns)","p99(ns)");
+  for( auto &e : GetProfile() ) {
+    std::fprintf(output,
+        "%-24s %10llu %10.1f %10.1f %10.1f %10.1f %8llu %10llu %10llu\n",
+        e.name.c_str(),
+        static_cast<unsigned long long>(e.count),
+        e.build_ns  / 1000.0,
+        e.alloc_ns  / 1000.0,
+        e.lookup_ns / 1000.0,
+        e.setter_ns / 1000.0,
+        static_cast<unsigned long long>(e.miss),
+        static_cast<unsigned long long>(e.Percentile(0.5)),
+        static_cast<unsigned long long>(e.Percentile(0.99)));
+  }
+}
+
+} // namespace dinject
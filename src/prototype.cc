@@ -0,0 +1,42 @@
+#include "prototype.h"
+
+#include <string>
+#include <unordered_map>
+
+namespace dinject {
+namespace detail {
+
+namespace {
+
+class PrototypeManager {
+ public:
+  static PrototypeManager& GetInstance() {
+    static PrototypeManager kInstance;
+    return kInstance;
+  }
+
+  void Add( const char* name , std::unique_ptr<Prototype>&& prototype ) {
+    prototypes_[name] = std::move(prototype);
+  }
+
+  const Prototype* Find( const char* name ) const {
+    auto itr = prototypes_.find(name);
+    return itr == prototypes_.end() ? NULL : itr->second.get();
+  }
+
+ private:
+  std::unordered_map<std::string,std::unique_ptr<Prototype>> prototypes_;
+};
+
+} // namespace
+
+void AddPrototype( const char* name , std::unique_ptr<Prototype>&& prototype ) {
+  PrototypeManager::GetInstance().Add(name,std::move(prototype));
+}
+
+const Prototype* FindPrototype( const char* name ) {
+  return PrototypeManager::GetInstance().Find(name);
+}
+
+} // namespace detail
+} // namespace dinject
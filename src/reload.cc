@@ -0,0 +1,233 @@
+#include "reload.h"
+
+#include <cassert>
+#include <string>
+
+namespace dinject {
+namespace detail {
+namespace {
+
+bool SameConfig( const ConfigObject& l , const ConfigObject& r );
+
+bool SameValue( const ConfigValue& l , const ConfigValue& r ) {
+  if(l.index() != r.index()) return false;
+  auto lo = std::get_if<std::shared_ptr<ConfigObject>>(&l);
+  if(!lo) return l == r;
+  auto &ro = std::get<std::shared_ptr<ConfigObject>>(r);
+  if(lo->get() == ro.get()) return true;
+  return *lo && ro && SameConfig(**lo,*ro);
+}
+
+// Count entries of a config
+class CountVisitor : public ConfigObject::Visitor {
+ public:
+  CountVisitor() : count(0) {}
+
+  virtual void Visit( std::string_view , Symbol , const ConfigValue& ) {
+    ++count;
+  }
+
+  virtual void VisitString( std::string_view , Symbol , std::string_view ) {
+    ++count;
+  }
+
+  std::size_t count;
+};
+
+// Whether every entry visited is found in other with the same value
+class EqualVisitor : public ConfigObject::Visitor {
+ public:
+  explicit EqualVisitor( const ConfigObject& other ):
+    count(0), equal(true), other_(other)
+  {}
+
+  virtual void Visit( std::string_view key , Symbol ,
+                                             const ConfigValue& val ) {
+    if(!equal) return;
+    ++count;
+    auto v = other_.Get(std::string(key));
+    equal = v && SameValue(val,*v);
+  }
+
+  std::size_t count;
+  bool equal;
+
+ private:
+  const ConfigObject& other_;
+};
+
+bool SameConfig( const ConfigObject& l , const ConfigObject& r ) {
+  if(&l == &r) return true;
+  EqualVisitor equal(r);
+  l.ForEach(&equal);
+  if(!equal.equal) return false;
+  CountVisitor count;
+  r.ForEach(&count);
+  return count.count == equal.count;
+}
+
+class DiffVisitor : public ConfigObject::Visitor {
+ public:
+  DiffVisitor( KlassBuilder* builder , const ConfigObject& old_config ,
+               DiffContext* context , const std::string& prefix ):
+    changed(0), builder_(builder), old_(old_config), context_(context),
+    prefix_(prefix)
+  {}
+
+  virtual void Visit( std::string_view key , Symbol symbol ,
+                                             const ConfigValue& val ) {
+    auto attr = Resolve(key,symbol);
+    if(!attr) return;
+
+    auto prev = old_.Get(std::string(key));
+    if(prev && SameValue(*prev,val)) return;
+
+    if(auto str = std::get_if<std::string>(&val)) {
+      if(ApplyReference(attr,*str)) return;
+    }
+
+    detail::Value primitive;
+    if(ConvertPrimitive(val,&primitive)) {
+      if(attr->type() == kTypeStruct ||
+         !builder_->Build(attr,std::move(primitive))) {
+        Mismatch(attr,GetValueTypeName(val));
+        return;
+      }
+      ++changed;
+      return;
+    }
+
+    auto &obj = *std::get_if<std::shared_ptr<ConfigObject>>(&val);
+
+    if(attr->type() == kTypeObject) {
+      // a changed subtree is rebuilt as a whole
+      BuilderStorage storage;
+      auto sub = NewKlassObject(attr->dep_symbol(),&storage);
+      if(!sub) {
+        Report(BuildError::kUnknownClass,attr,"");
+        return;
+      }
+      BuildError error;
+      BuildContext build;
+      build.container = context_->container;
+      build.scope     = context_->scope;
+      build.error     = context_->errors ? &error : NULL;
+      Build(sub,*obj,&build);
+      if(build.failed) {
+        error.path = Path(attr) + "." + error.path;
+        context_->errors->push_back(std::move(error));
+        context_->failed = true;
+        return;
+      }
+      if(!builder_->Build(attr,detail::Value(sub->PeekRef()))) {
+        Mismatch(attr,"object");
+        return;
+      }
+      sub->GetRef();
+      ++changed;
+    } else if(attr->type() == kTypeStruct) {
+      // struct is updated in place , only with its own changes
+      auto prev_obj = prev ?
+        std::get_if<std::shared_ptr<ConfigObject>>(prev) : NULL;
+      BuilderStorage storage;
+      auto sub = builder_->BuildStruct(attr,&storage);
+      if(sub) {
+        auto old_obj = (prev_obj && *prev_obj) ? *prev_obj :
+                                                 NewDefaultConfigObject();
+        DiffVisitor visitor(sub,*old_obj,context_,Path(attr) + ".");
+        obj->ForEach(&visitor);
+        changed += visitor.changed;
+      }
+    } else {
+      // nested config for a primitive attribute
+      Mismatch(attr,"object");
+    }
+  }
+
+  virtual bool Wants( std::string_view key , Symbol symbol ) {
+    return wanted_.Set(key,symbol,Find(key,symbol)) != NULL;
+  }
+
+  std::size_t changed;
+
+ private:
+  Attribute* Find( std::string_view key , Symbol symbol ) const {
+    return symbol != kNoSymbol ? builder_->FindAttribute(symbol) :
+                                 builder_->FindAttribute(key);
+  }
+
+  Attribute* Resolve( std::string_view key , Symbol symbol ) {
+    Attribute* attr;
+    return wanted_.Take(key,symbol,&attr) ? attr : Find(key,symbol);
+  }
+
+  // A string "@name" of an object attribute refers to a named instance of
+  // the container , same as BuildVisitor::BuildReference
+  bool ApplyReference( Attribute* attr , std::string_view val ) {
+    if(attr->type() != kTypeObject) return false;
+    if(val.empty() || val.front() != '@') return false;
+    if(!context_->container) {
+      Report(BuildError::kTypeMismatch,attr,"reference");
+      return true;
+    }
+    if(!builder_->Build(attr,detail::Value(
+          ResolveReference(context_->container,val.substr(1),
+                                               context_->scope)))) {
+      Mismatch(attr,"object");
+      return true;
+    }
+    ++changed;
+    return true;
+  }
+
+  // Skip a change which can't be applied
+  void Report( BuildError::Code code , Attribute* attr , const char* actual ) {
+    context_->failed = true;
+    if(!context_->errors) return;
+    BuildError error;
+    error.code     = code;
+    error.klass    = code == BuildError::kUnknownClass ?
+                     attr->type_name() : builder_->klass()->name();
+    error.path     = Path(attr);
+    error.expected = attr->type_name();
+    error.actual   = actual;
+    context_->errors->push_back(std::move(error));
+  }
+
+  // The value doesn't match the type of the attribute , aborts unless the
+  // errors are collected
+  void Mismatch( Attribute* attr , const char* actual ) {
+    if(!context_->errors) TypeMismatch(builder_->klass(),attr);
+    Report(BuildError::kTypeMismatch,attr,actual);
+  }
+
+  std::string Path( Attribute* attr ) const {
+    return prefix_ + attr->name();
+  }
+
+  static const char* GetValueTypeName( const ConfigValue& val ) {
+    static const char* const kName[] = {
+      "bool" , "int64" , "double" , "string" , "object"
+    };
+    return kName[val.index()];
+  }
+
+  KlassBuilder* builder_;
+  const ConfigObject& old_;
+  DiffContext* context_;
+  std::string prefix_;
+  WantedAttribute wanted_;
+};
+
+} // namespace
+
+std::size_t ApplyDiff( KlassBuilder* builder , const ConfigObject& old_config ,
+                                               const ConfigObject& new_config ,
+                                               DiffContext* context ) {
+  DiffVisitor visitor(builder,old_config,context,std::string());
+  new_config.ForEach(&visitor);
+  return visitor.changed;
+}
+
+} // namespace detail
+} // namespace dinject
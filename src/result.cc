@@ -0,0 +1,24 @@
+#include "result.h"
+
+namespace dinject {
+
+std::string BuildError::ToString() const {
+  switch(code) {
+    case kOk:
+      return "ok";
+    case kUnknownClass:
+      if(!path.empty())
+        return "class " + klass + " of attribute " + path +
+               " is not registered";
+      return "class " + klass + " is not registered";
+    case kWrongType:
+      return "class " + klass + " doesn't create objects of type " + expected;
+    case kUnknownKey:
+      return "object " + klass + " has no attribute " + path;
+    default:
+      return "object " + klass + "'s attribute " + path + " expect type " +
+             expected + " , got " + actual;
+  }
+}
+
+} // namespace dinject
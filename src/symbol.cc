@@ -0,0 +1,74 @@
+#include "symbol.h"
+#include "error.h"
+
+#include <deque>
+#include <string>
+#include <unordered_map>
+
+namespace dinject {
+
+namespace {
+
+class SymbolTable {
+ public:
+  static SymbolTable& GetInstance() {
+    static SymbolTable kInstance;
+    return kInstance;
+  }
+
+  Symbol Intern( std::string_view name ) {
+    auto itr = index_.find(name);
+    if(itr != index_.end()) return itr->second;
+
+    if(frozen_) {
+      detail::Fatal("symbol table is frozen , cannot intern %.*s",
+                    static_cast<int>(name.size()),name.data());
+    }
+
+    // std::deque never moves its element , so the string_view key which
+    // points into the stored name is stable
+    names_.emplace_back(name);
+    auto symbol = static_cast<Symbol>(names_.size());
+    index_.emplace(std::string_view(names_.back()),symbol);
+    return symbol;
+  }
+
+  Symbol Find( std::string_view name ) const {
+    auto itr = index_.find(name);
+    return itr == index_.end() ? kNoSymbol : itr->second;
+  }
+
+  void Freeze() { frozen_ = true; }
+
+  const char* GetName( Symbol symbol ) const {
+    if(symbol == kNoSymbol || symbol > names_.size()) return NULL;
+    return names_[symbol-1].c_str();
+  }
+
+ private:
+  SymbolTable() : index_(), names_(), frozen_(false) {}
+
+  std::unordered_map<std::string_view,Symbol> index_;
+  std::deque<std::string> names_;
+  bool frozen_;
+};
+
+} // namespace
+
+Symbol Intern( std::string_view name ) {
+  return SymbolTable::GetInstance().Intern(name);
+}
+
+Symbol FindSymbol( std::string_view name ) {
+  return SymbolTable::GetInstance().Find(name);
+}
+
+void FreezeSymbolTable() {
+  SymbolTable::GetInstance().Freeze();
+}
+
+const char* GetSymbolName( Symbol symbol ) {
+  return SymbolTable::GetInstance().GetName(symbol);
+}
+
+} // namespace dinject
@@ -0,0 +1,173 @@
+#include "trace.h"
+
+#ifdef DINJECT_TRACE
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+#endif // DINJECT_TRACE
+
+namespace dinject {
+
+#ifdef DINJECT_TRACE
+
+namespace detail {
+namespace {
+
+struct TraceEvent {
+  std::uint64_t ts;    // ns of the steady clock
+  Symbol name;
+  std::uint8_t kind;
+  char phase;          // 'B' or 'E'
+};
+
+// Single producer single consumer ring , the owner thread advances head and
+// FlushTrace advances tail while holding kRingLock
+struct TraceRing {
+  std::uint32_t tid;
+  std::atomic<std::uint64_t> head;
+  std::atomic<std::uint64_t> tail;
+  std::size_t open;    // recorded spans without end event , owner only
+  std::unique_ptr<TraceEvent[]> events;
+
+  explicit TraceRing( std::uint32_t id ):
+    tid(id), head(0), tail(0), open(0),
+    events(new TraceEvent[kTraceRingSize])
+  {}
+};
+
+std::atomic<bool> kTracing(false);
+std::atomic<std::uint64_t> kDropped(0);
+
+// All rings , a ring is kept after its thread exits until it is flushed
+std::mutex kRingLock;
+std::vector<std::shared_ptr<TraceRing>> kRings;
+std::uint32_t kNextTid = 1;
+
+thread_local std::shared_ptr<TraceRing> kLocalRing;
+
+TraceRing* GetRing() {
+  if(!kLocalRing) {
+    std::lock_guard<std::mutex> lock(kRingLock);
+    kLocalRing = std::make_shared<TraceRing>(kNextTid++);
+    kRings.push_back(kLocalRing);
+  }
+  return kLocalRing.get();
+}
+
+inline std::uint64_t Now() {
+  return static_cast<std::uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+inline void Push( TraceRing* ring , TraceKind kind , Symbol name ,
+                                                     char phase ) {
+  auto head = ring->head.load(std::memory_order_relaxed);
+  ring->events[head & (kTraceRingSize - 1)] =
+    TraceEvent{Now(),name,static_cast<std::uint8_t>(kind),phase};
+  ring->head.store(head + 1,std::memory_order_release);
+}
+
+const char* const kCategory[] = { "new" , "object" , "struct" , "setter" };
+
+void WriteString( std::FILE* output , const char* str ) {
+  std::fputc('"',output);
+  for( ; *str ; ++str ) {
+    auto c = static_cast<unsigned char>(*str);
+    if(c == '"' || c == '\\') {
+      std::fputc('\\',output);
+      std::fputc(c,output);
+    } else if(c < 0x20) {
+      std::fprintf(output,"\\u%04x",c);
+    } else {
+      std::fputc(c,output);
+    }
+  }
+  std::fputc('"',output);
+}
+
+} // namespace
+
+bool TraceBegin( TraceKind kind , Symbol name ) {
+  if(!kTracing.load(std::memory_order_relaxed)) return false;
+  auto ring = GetRing();
+  auto used = ring->head.load(std::memory_order_relaxed) -
+              ring->tail.load(std::memory_order_acquire);
+  // keep room for the end events of all the open spans
+  if(kTraceRingSize - used < ring->open + 2) {
+    kDropped.fetch_add(1,std::memory_order_relaxed);
+    return false;
+  }
+  Push(ring,kind,name,'B');
+  ++ring->open;
+  return true;
+}
+
+void TraceEnd( TraceKind kind , Symbol name ) {
+  auto ring = kLocalRing.get();
+  Push(ring,kind,name,'E');
+  --ring->open;
+}
+
+} // namespace detail
+
+bool TraceEnabled() { return true; }
+
+void StartTrace() { detail::kTracing.store(true); }
+
+void StopTrace() { detail::kTracing.store(false); }
+
+std::size_t FlushTrace( std::FILE* output ) {
+  std::lock_guard<std::mutex> lock(detail::kRingLock);
+  std::size_t count = 0;
+  std::fprintf(output,"{\"traceEvents\":[");
+  for( auto &ring : detail::kRings ) {
+    auto tail = ring->tail.load(std::memory_order_relaxed);
+    auto head = ring->head.load(std::memory_order_acquire);
+    for( ; tail != head ; ++tail ) {
+      auto &e = ring->events[tail & (kTraceRingSize - 1)];
+      auto name = GetSymbolName(e.name);
+      std::fprintf(output,count ? ",\n" : "\n");
+      std::fprintf(output,"{\"name\":");
+      detail::WriteString(output,name ? name : "");
+      std::fprintf(output,",\"cat\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,"
+                          "\"pid\":1,\"tid\":%u}",
+                   detail::kCategory[e.kind],e.phase,e.ts / 1000.0,
+                   static_cast<unsigned>(ring->tid));
+      ++count;
+    }
+    ring->tail.store(tail,std::memory_order_release);
+  }
+  std::fprintf(output,"\n]}\n");
+
+  // rings of exited threads are not referenced by anything else
+  std::vector<std::shared_ptr<detail::TraceRing>> live;
+  for( auto &ring : detail::kRings ) {
+    if(ring.use_count() > 1) live.push_back(std::move(ring));
+  }
+  detail::kRings.swap(live);
+  return count;
+}
+
+std::uint64_t TraceDropped() { return detail::kDropped.load(); }
+
+#else
+
+bool TraceEnabled() { return false; }
+
+void StartTrace() {}
+
+void StopTrace() {}
+
+std::size_t FlushTrace( std::FILE* output ) {
+  std::fprintf(output,"{\"traceEvents\":[]}\n");
+  return 0;
+}
+
+std::uint64_t TraceDropped() { return 0; }
+
+#endif // DINJECT_TRACE
+
+} // namespace dinject
@@ -0,0 +1,129 @@
+#include "validate.h"
+
+#include <string>
+
+namespace dinject {
+namespace detail {
+namespace {
+
+bool IsConfig( const ConfigValue& val ) {
+  auto obj = std::get_if<std::shared_ptr<ConfigObject>>(&val);
+  return obj && *obj;
+}
+
+// Whether the build path accepts a config value of this type for the
+// attribute , see the setters in meta.h
+bool Accepts( const Attribute* attr , const ConfigValue& val ,
+                                      bool references ) {
+  switch(attr->type()) {
+#define __(A,B,C,D)                                      \
+    case A: { D v = D(); return GetPrimitive(val,&v); }
+    DINJECT_PRIMITIVE_TYPE(__)
+#undef __ // __
+    case kTypeString:
+      return std::holds_alternative<std::string>(val);
+    case kTypeObject:
+      // "@name" is resolved by Container::New into a shared instance
+      if(auto str = std::get_if<std::string>(&val)) {
+        return references && attr->is_shared() &&
+               !str->empty() && str->front() == '@';
+      }
+      return IsConfig(val);
+    default:
+      return IsConfig(val);
+  }
+}
+
+const char* GetValueTypeName( const ConfigValue& val ) {
+  static const char* const kName[] = {
+    "bool" , "int64" , "double" , "string" , "object"
+  };
+  auto obj = std::get_if<std::shared_ptr<ConfigObject>>(&val);
+  return (obj && !*obj) ? "null" : kName[val.index()];
+}
+
+class ValidateVisitor : public ConfigObject::Visitor {
+ public:
+  ValidateVisitor( const Klass* klass , const std::string& prefix ,
+                                        bool references ,
+                                        std::vector<BuildError>* errors ):
+    klass_(klass), prefix_(prefix), references_(references), errors_(errors)
+  {}
+
+  virtual void Visit( std::string_view key , Symbol symbol ,
+                                             const ConfigValue& val ) {
+    auto attr = symbol != kNoSymbol ? klass_->ResolveAttribute(symbol) :
+                                      klass_->ResolveAttribute(key);
+    if(!attr) {
+      Report(BuildError::kUnknownKey,key,"",GetValueTypeName(val));
+      return;
+    }
+    if(!Accepts(attr,val,references_)) {
+      Report(BuildError::kTypeMismatch,key,attr->type_name(),
+                                           GetValueTypeName(val));
+      return;
+    }
+    if(attr->type() != kTypeObject && attr->type() != kTypeStruct) return;
+
+    auto obj = std::get_if<std::shared_ptr<ConfigObject>>(&val);
+    if(!obj) return;   // reference to a Container instance
+
+    auto sub = GetKlass(attr->dep_symbol());
+    if(!sub) {
+      Report(BuildError::kUnknownClass,key,attr->type_name(),"");
+      return;
+    }
+    ValidateVisitor visitor(sub,Path(key) + ".",references_,errors_);
+    (*obj)->ForEach(&visitor);
+  }
+
+  virtual void VisitString( std::string_view key , Symbol symbol ,
+                                                   std::string_view val ) {
+    Visit(key,symbol,ConfigValue(std::string(val)));
+  }
+
+ private:
+  std::string Path( std::string_view key ) const {
+    return prefix_ + std::string(key);
+  }
+
+  void Report( BuildError::Code code , std::string_view key ,
+               const char* expected , const char* actual ) {
+    BuildError error;
+    error.code     = code;
+    error.klass    = code == BuildError::kUnknownClass ? expected :
+                                                         klass_->name();
+    error.path     = Path(key);
+    error.expected = expected;
+    error.actual   = actual;
+    errors_->push_back(std::move(error));
+  }
+
+  const Klass* klass_;
+  std::string prefix_;
+  bool references_;
+  std::vector<BuildError>* errors_;
+};
+
+} // namespace
+} // namespace detail
+
+std::vector<BuildError> Validate( const char* klass ,
+                                  const ConfigObject& config ,
+                                  bool references ) {
+  std::vector<BuildError> errors;
+  auto symbol = FindSymbol(klass);
+  auto kls = symbol != kNoSymbol ? detail::GetKlass(symbol) : NULL;
+  if(!kls) {
+    BuildError error;
+    error.code  = BuildError::kUnknownClass;
+    error.klass = klass;
+    errors.push_back(std::move(error));
+    return errors;
+  }
+  detail::ValidateVisitor visitor(kls,std::string(),references,&errors);
+  config.ForEach(&visitor);
+  return errors;
+}
+
+} // namespace dinject
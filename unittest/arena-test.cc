@@ -0,0 +1,132 @@
+#include "dinject.h"
+#include "arena.h"
+
+#include <iostream>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+static int kAlive = 0;
+
+struct Texture {
+  std::string path;
+  std::int32_t size;
+
+  Texture() : path(), size() { ++kAlive; }
+  ~Texture() { --kAlive; }
+
+  void SetPath( const std::string& v ) { path = v; }
+  void SetSize( std::int32_t v )       { size = v; }
+};
+
+DINJECT_CLASS(Texture) {
+  dinject::Class<Texture>("texture")
+    .AddString                 ("path",&Texture::SetPath)
+    .AddPrimitive<std::int32_t>("size",&Texture::SetSize);
+}
+
+struct Sprite {
+  std::int32_t layer;
+  Texture* texture;   // owned by the arena
+
+  Sprite() : layer(), texture() { ++kAlive; }
+  ~Sprite() { --kAlive; }
+
+  void SetLayer  ( std::int32_t v ) { layer = v; }
+  void SetTexture( Texture* v )     { texture = v; }
+};
+
+DINJECT_CLASS(Sprite) {
+  dinject::Class<Sprite>("sprite")
+    .AddPrimitive<std::int32_t>("layer",&Sprite::SetLayer)
+    .AddObject<Texture>        ("texture","texture",&Sprite::SetTexture);
+}
+
+struct Layer {
+  std::shared_ptr<Texture> texture;
+
+  Layer() : texture() { ++kAlive; }
+  ~Layer() { --kAlive; }
+
+  void SetTexture( std::shared_ptr<Texture> v ) { texture = std::move(v); }
+};
+
+DINJECT_CLASS(Layer) {
+  dinject::Class<Layer>("layer")
+    .AddShared<Texture>("texture","texture",&Layer::SetTexture);
+}
+
+int main() {
+  auto texture = dinject::NewDefaultConfigObject();
+  texture->Set("path",dinject::Val("a/very/long/path/to/the/texture.png"));
+  texture->Set("size",dinject::Val(256));
+
+  auto sprite = dinject::NewDefaultConfigObject();
+  sprite->Set("layer",dinject::Val(3));
+  sprite->Set("texture",dinject::Val(texture));
+
+  {
+    dinject::Arena arena(1024);
+    std::vector<Sprite*> sprites;
+    for( int i = 0 ; i < 100 ; ++i ) {
+      auto s = dinject::New<Sprite>("sprite",*sprite,arena);
+      assert( s );
+      assert( s->layer == 3 );
+      assert( s->texture );
+      assert( s->texture->size == 256 );
+      assert( s->texture->path == "a/very/long/path/to/the/texture.png" );
+      sprites.push_back(s);
+    }
+    assert( kAlive == 200 );
+    assert( arena.size() >= 100 * (sizeof(Sprite) + sizeof(Texture)) );
+
+    // unknown class
+    assert( !dinject::New<Sprite>("no-such-class",*sprite,arena) );
+
+    arena.Reset();
+    assert( kAlive == 0 );
+    assert( arena.size() == 0 );
+
+    auto s = dinject::New<Sprite>("sprite",*sprite,arena);
+    assert( s->texture->size == 256 );
+    assert( kAlive == 2 );
+  }
+  assert( kAlive == 0 );
+
+  // the object of a shared attribute is created on heap , it outlives the
+  // arena since it is owned by its std::shared_ptr
+  {
+    auto layer = dinject::NewDefaultConfigObject();
+    layer->Set("texture",dinject::Val(texture));
+
+    std::shared_ptr<Texture> kept;
+    {
+      dinject::Arena arena;
+      auto l = dinject::New<Layer>("layer",*layer,arena);
+      assert( l && l->texture );
+      assert( l->texture->size == 256 );
+      assert( kAlive == 2 );
+      kept = l->texture;
+    }
+    assert( kAlive == 1 );
+    assert( kept.use_count() == 1 );
+    kept.reset();
+    assert( kAlive == 0 );
+  }
+
+  // arena can back pmr containers
+  {
+    dinject::Arena arena;
+    std::pmr::vector<int> vec(&arena);
+    for( int i = 0 ; i < 10000 ; ++i ) vec.push_back(i);
+    assert( vec[9999] == 9999 );
+
+    // allocation larger than the block size
+    auto big = static_cast<char*>(arena.Allocate(1024*1024,64));
+    assert( reinterpret_cast<std::uintptr_t>(big) % 64 == 0 );
+    big[1024*1024-1] = 1;
+  }
+
+  std::cout<<"tests passed\n";
+  return 0;
+}
@@ -0,0 +1,197 @@
+#include "dinject.h"
+#include "binary.h"
+#include "executor.h"
+
+#include <iostream>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+struct Stat {
+  std::int32_t armor;
+  double speed;
+
+  Stat() : armor(), speed() {}
+
+  void SetArmor( std::int32_t v ) { armor = v; }
+  void SetSpeed( double v )       { speed = v; }
+};
+
+DINJECT_CLASS(Stat) {
+  dinject::Class<Stat>("stat")
+    .AddPrimitive<std::int32_t>("armor",&Stat::SetArmor)
+    .AddPrimitive<double>      ("speed",&Stat::SetSpeed);
+}
+
+struct Item {
+  std::string name;
+
+  Item() : name() {}
+
+  void SetName( const std::string& v ) { name = v; }
+};
+
+DINJECT_CLASS(Item) {
+  dinject::Class<Item>("item")
+    .AddString("name",&Item::SetName);
+}
+
+struct Prefab {
+  std::int64_t id;
+  bool active;
+  std::string label;
+  Stat stat;
+  std::unique_ptr<Item> left;
+  std::unique_ptr<Item> right;
+
+  Prefab() : id(), active(), label(), stat(), left(), right() {}
+
+  void SetId    ( std::int64_t v )       { id = v; }
+  void SetActive( bool v )               { active = v; }
+  void SetLabel ( const std::string& v ) { label = v; }
+  void SetLeft  ( Item* v )              { left.reset(v); }
+  void SetRight ( Item* v )              { right.reset(v); }
+  Stat* GetStat()                        { return &stat; }
+};
+
+DINJECT_CLASS(Prefab) {
+  dinject::Class<Prefab>("prefab")
+    .AddPrimitive<std::int64_t>("id",&Prefab::SetId)
+    .AddPrimitive<bool>        ("active",&Prefab::SetActive)
+    .AddString                 ("label",&Prefab::SetLabel)
+    .AddStruct<Stat>           ("stat","stat",&Prefab::GetStat)
+    .AddObject<Item>           ("left","item",&Prefab::SetLeft)
+    .AddObject<Item>           ("right","item",&Prefab::SetRight);
+}
+
+static void Check( const Prefab& p ) {
+  assert( p.id == 7 );
+  assert( p.active );
+  assert( p.label == "crate" );
+  assert( p.stat.armor == 3 );
+  assert( p.stat.speed == 0.5 );
+  assert( p.left && p.left->name == "sword" );
+  assert( p.right && p.right->name == "shield" );
+}
+
+int main() {
+  dinject::Freeze();
+
+  auto config = dinject::NewDefaultConfigObject();
+  config->Set("id",dinject::Val(7));
+  config->Set("active",dinject::Val(true));
+  config->Set("label",dinject::Val("crate"));
+  config->Set("extra",dinject::Val("not an attribute"));
+  {
+    auto stat = dinject::NewDefaultConfigObject();
+    stat->Set("armor",dinject::Val(3));
+    stat->Set("speed",dinject::Val(0.5));
+    config->Set("stat",dinject::Val(stat));
+
+    auto left = dinject::NewDefaultConfigObject();
+    left->Set("name",dinject::Val("sword"));
+    config->Set("left",dinject::Val(left));
+
+    auto right = dinject::NewDefaultConfigObject();
+    right->Set("name",dinject::Val("shield"));
+    config->Set("right",dinject::Val(right));
+  }
+
+  std::string data;
+  assert( dinject::WriteBinaryConfig(*config,&data) );
+
+  // in memory view
+  {
+    std::string error;
+    auto view = dinject::LoadBinaryConfig(data,&error);
+    assert( view );
+    Check(*dinject::New<Prefab>("prefab",*view));
+
+    // Get materializes the value and the pointer is stable
+    auto id = view->Get("id");
+    assert( id && std::get<std::int64_t>(*id) == 7 );
+    assert( view->Get("id") == id );
+    assert( std::get<std::string>(*view->Get(std::string("label"))) == "crate" );
+    assert( !view->Get("none") );
+
+    auto stat = view->Get("stat");
+    auto &sub = std::get<std::shared_ptr<dinject::ConfigObject>>(*stat);
+    assert( std::get<double>(*sub->Get("speed")) == 0.5 );
+
+    // iterator yields the same entries as the source
+    std::size_t count = 0;
+    for( auto itr(view->NewIterator()) ; itr->HasNext() ; itr->Next() ) {
+      std::string key;
+      dinject::ConfigValue value;
+      itr->Get(&key,&value);
+      assert( config->Get(key) );
+      assert( config->Get(key)->index() == value.index() );
+      ++count;
+    }
+    assert( count == 7 );
+
+    // a child from iteration keeps the file alive
+    std::shared_ptr<dinject::ConfigObject> child;
+    for( auto itr(view->NewIterator()) ; itr->HasNext() ; itr->Next() ) {
+      if(itr->GetSymbol() != dinject::FindSymbol("stat")) continue;
+      std::string key;
+      dinject::ConfigValue value;
+      itr->Get(&key,&value);
+      child = std::get<std::shared_ptr<dinject::ConfigObject>>(value);
+    }
+    view.reset();
+    assert( child );
+    assert( std::get<std::int64_t>(*child->Get("armor")) == 3 );
+
+    // round trip
+    std::string again;
+    assert( dinject::WriteBinaryConfig(*child,&again) );
+    auto copy = dinject::LoadBinaryConfig(again);
+    assert( std::get<double>(*copy->Get("speed")) == 0.5 );
+  }
+
+  // memory mapped file
+  {
+    const char* path = "binary-test.bin";
+    assert( dinject::WriteBinaryConfig(*config,path) );
+    std::string error;
+    auto view = dinject::OpenBinaryConfig(path,&error);
+    assert( view );
+    Check(*dinject::New<Prefab>("prefab",*view));
+
+    dinject::ThreadPool pool(2);
+    Check(*dinject::NewParallel<Prefab>("prefab",*view,pool));
+    std::remove(path);
+
+    assert( !dinject::OpenBinaryConfig("no-such-file.bin",&error) );
+    assert( !error.empty() );
+  }
+
+  // corrupted data is rejected
+  {
+    std::string error;
+    assert( !dinject::LoadBinaryConfig(std::string(),&error) );
+    assert( !dinject::LoadBinaryConfig(data.substr(0,data.size()-1),&error) );
+
+    std::string bad = data;
+    bad[0] = 'x';
+    assert( !dinject::LoadBinaryConfig(bad,&error) );
+
+    // every byte flip is either rejected or still safe to read
+    for( std::size_t i = 0 ; i < data.size() ; ++i ) {
+      std::string flip = data;
+      flip[i] = static_cast<char>(flip[i] ^ 0x5a);
+      auto view = dinject::LoadBinaryConfig(flip);
+      if(view) {
+        for( auto itr(view->NewIterator()) ; itr->HasNext() ; itr->Next() ) {
+          std::string key;
+          dinject::ConfigValue value;
+          itr->Get(&key,&value);
+        }
+      }
+    }
+  }
+
+  std::cout<<"tests passed\n";
+  return 0;
+}
@@ -0,0 +1,166 @@
+#include "dinject.h"
+#include "container.h"
+
+#include <iostream>
+#include <cstdint>
+#include <string>
+
+static int kCacheCount = 0;
+
+struct TextureCache {
+  std::int64_t size;
+
+  TextureCache() : size() { ++kCacheCount; }
+
+  void SetSize( std::int64_t v ) { size = v; }
+};
+
+DINJECT_CLASS(TextureCache) {
+  dinject::Class<TextureCache>("texture_cache")
+    .AddPrimitive<std::int64_t>("size",&TextureCache::SetSize);
+}
+
+struct Renderer {
+  std::shared_ptr<TextureCache> cache;
+
+  Renderer() : cache() {}
+
+  void SetCache( std::shared_ptr<TextureCache> v ) { cache = std::move(v); }
+};
+
+DINJECT_CLASS(Renderer) {
+  dinject::Class<Renderer>("renderer")
+    .AddShared<TextureCache>("cache","texture_cache",&Renderer::SetCache);
+}
+
+struct Sprite {
+  std::string name;
+  std::shared_ptr<TextureCache> cache;
+  std::shared_ptr<Renderer> renderer;
+
+  Sprite() : name(), cache(), renderer() {}
+
+  void SetName    ( const std::string& v )        { name = v; }
+  void SetCache   ( std::shared_ptr<TextureCache> v ) { cache = std::move(v); }
+  void SetRenderer( std::shared_ptr<Renderer> v )     { renderer = std::move(v); }
+};
+
+DINJECT_CLASS(Sprite) {
+  dinject::Class<Sprite>("sprite")
+    .AddString               ("name",&Sprite::SetName)
+    .AddShared<TextureCache> ("cache","texture_cache",&Sprite::SetCache)
+    .AddShared<Renderer>     ("renderer","renderer",&Sprite::SetRenderer);
+}
+
+struct Scene {
+  std::unique_ptr<Sprite> a;
+  std::unique_ptr<Sprite> b;
+
+  Scene() : a(), b() {}
+
+  void SetA( Sprite* v ) { a.reset(v); }
+  void SetB( Sprite* v ) { b.reset(v); }
+};
+
+DINJECT_CLASS(Scene) {
+  dinject::Class<Scene>("scene")
+    .AddObject<Sprite>("a","sprite",&Scene::SetA)
+    .AddObject<Sprite>("b","sprite",&Scene::SetB);
+}
+
+static std::shared_ptr<dinject::ConfigObject> NewSprite( const char* cache ) {
+  auto sprite = dinject::NewDefaultConfigObject();
+  sprite->Set("name",dinject::Val("sprite"));
+  sprite->Set("cache",dinject::Val(cache));
+  return sprite;
+}
+
+static std::shared_ptr<dinject::ConfigObject> NewScene( const char* cache ) {
+  auto scene = dinject::NewDefaultConfigObject();
+  scene->Set("a",dinject::Val(NewSprite(cache)));
+  scene->Set("b",dinject::Val(NewSprite(cache)));
+  return scene;
+}
+
+int main() {
+  dinject::Freeze();
+
+  auto cache_config = dinject::NewDefaultConfigObject();
+  cache_config->Set("size",dinject::Val(64));
+
+  dinject::Container container;
+  container.Register("cache","texture_cache",cache_config);
+  container.Register("frame_cache","texture_cache",cache_config,
+                     dinject::Container::kPerBuild);
+  container.Register("temp_cache","texture_cache",cache_config,
+                     dinject::Container::kTransient);
+
+  // singleton is built once and shared across builds
+  {
+    kCacheCount = 0;
+    auto s1 = container.New<Scene>("scene",*NewScene("@cache"));
+    auto s2 = container.New<Scene>("scene",*NewScene("@cache"));
+    assert( kCacheCount == 1 );
+    assert( s1->a->cache && s1->a->cache->size == 64 );
+    assert( s1->a->cache == s1->b->cache );
+    assert( s1->a->cache == s2->a->cache );
+    assert( s1->a->cache == container.Get<TextureCache>("cache") );
+    assert( s1->a->name == "sprite" );
+  }
+
+  // per build instance is shared inside of one build only
+  {
+    kCacheCount = 0;
+    auto s1 = container.New<Scene>("scene",*NewScene("@frame_cache"));
+    auto s2 = container.New<Scene>("scene",*NewScene("@frame_cache"));
+    assert( kCacheCount == 2 );
+    assert( s1->a->cache == s1->b->cache );
+    assert( s1->a->cache != s2->a->cache );
+  }
+
+  // transient instance is built for every reference
+  {
+    kCacheCount = 0;
+    auto s = container.New<Scene>("scene",*NewScene("@temp_cache"));
+    assert( kCacheCount == 2 );
+    assert( s->a->cache != s->b->cache );
+  }
+
+  // registered instance and nested reference
+  {
+    auto cache = std::make_shared<TextureCache>();
+    cache->size = 7;
+    container.RegisterInstance("external",cache);
+
+    auto renderer = dinject::NewDefaultConfigObject();
+    renderer->Set("cache",dinject::Val("@external"));
+    container.Register("renderer","renderer",renderer);
+
+    auto sprite = dinject::NewDefaultConfigObject();
+    sprite->Set("renderer",dinject::Val("@renderer"));
+    sprite->Set("cache",dinject::Val("@external"));
+
+    auto s = container.New<Sprite>("sprite",*sprite);
+    assert( s->cache == cache );
+    assert( s->renderer && s->renderer->cache == cache );
+    assert( container.Get<Renderer>("renderer") == s->renderer );
+    assert( !container.Get<Renderer>("not_found") );
+  }
+
+  // a shared attribute can still take a nested config , the new object is
+  // owned by the shared_ptr
+  {
+    kCacheCount = 0;
+    auto sprite = dinject::NewDefaultConfigObject();
+    sprite->Set("cache",dinject::Val(cache_config));
+    auto s1 = dinject::New<Sprite>("sprite",*sprite);
+    auto s2 = container.New<Sprite>("sprite",*sprite);
+    assert( kCacheCount == 2 );
+    assert( s1->cache && s1->cache->size == 64 );
+    assert( s1->cache.use_count() == 1 );
+    assert( s2->cache && s2->cache != s1->cache );
+  }
+
+  std::cout<<"tests passed\n";
+  return 0;
+}
@@ -0,0 +1,38 @@
+#ifndef DINJECT_UNITTEST_DEATH_H_
+#define DINJECT_UNITTEST_DEATH_H_
+
+#include <csignal>
+#include <cstdlib>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace test {
+
+// Run the function in a child process , returns what it printed to stderr
+// if it aborted , otherwise an empty string
+template< typename F > std::string Aborts( F&& func ) {
+  int fd[2];
+  if(pipe(fd) != 0) return std::string();
+  auto pid = fork();
+  if(pid == 0) {
+    close(fd[0]);
+    dup2(fd[1],2);
+    func();
+    std::_Exit(0);
+  }
+  close(fd[1]);
+  std::string output;
+  char buf[256];
+  for( ssize_t n ; (n = read(fd[0],buf,sizeof(buf))) > 0 ; )
+    output.append(buf,n);
+  close(fd[0]);
+  int status = 0;
+  waitpid(pid,&status,0);
+  bool aborted = WIFSIGNALED(status) && WTERMSIG(status) == SIGABRT;
+  return aborted ? output : std::string();
+}
+
+} // namespace test
+
+#endif // DINJECT_UNITTEST_DEATH_H_
@@ -2,6 +2,7 @@
 
 #include <iostream>
 #include <cstdint>
+#include <vector>
 
 class MyObject {
  public:
@@ -78,6 +79,48 @@ DINJECT_CLASS(MyObject2) {
     .AddStruct<Entity>    ("entity","entity",&MyObject2::GetEntity);
 }
 
+// ConfigObject which only implements the iterator interface , used to
+// test the default ForEach implementation
+class VectorConfigObject : public dinject::ConfigObject {
+ public:
+  typedef std::vector<std::pair<std::string,dinject::ConfigValue>> Vector;
+
+  virtual const dinject::ConfigValue* Get( const char* name ) const {
+    for( auto &e : vec_ ) if(e.first == name) return &e.second;
+    return NULL;
+  }
+  virtual const dinject::ConfigValue* Get( const std::string& name ) const {
+    return Get(name.c_str());
+  }
+  virtual void Set( const char* name , const dinject::ConfigValue& v ) {
+    vec_.emplace_back(name,v);
+  }
+  virtual void Set( const std::string& name , const dinject::ConfigValue& v ) {
+    vec_.emplace_back(name,v);
+  }
+
+  class VectorIterator : public Iterator {
+   public:
+    VectorIterator( const Vector& v ) : vec_(v), pos_(0) {}
+    virtual bool HasNext() const { return pos_ < vec_.size(); }
+    virtual bool Next() { ++pos_; return HasNext(); }
+    virtual void Get( std::string* key , dinject::ConfigValue* val ) {
+      *key = vec_[pos_].first;
+      *val = vec_[pos_].second;
+    }
+   private:
+    const Vector& vec_;
+    std::size_t pos_;
+  };
+
+  virtual std::unique_ptr<Iterator> NewIterator() const {
+    return std::unique_ptr<Iterator>(new VectorIterator(vec_));
+  }
+
+ private:
+  Vector vec_;
+};
+
 int main() {
   auto root = dinject::NewDefaultConfigObject();
   root->Set("a",dinject::Val(1.0));
@@ -135,6 +178,27 @@ int main() {
     assert( c->str == "uu");
   }
 
+  {
+    VectorConfigObject config;
+    config.Set("a",dinject::Val(3));
+    config.Set("Str",dinject::Val("vector"));
+    config.Set("missing",dinject::Val(false));
+
+    std::size_t count = 0;
+    struct Counter : public dinject::ConfigObject::Visitor {
+      std::size_t* count;
+      virtual void Visit( std::string_view , dinject::Symbol ,
+                          const dinject::ConfigValue& ) { ++*count; }
+    } counter;
+    counter.count = &count;
+    config.ForEach(&counter);
+    assert( count == 3 );
+
+    auto obj = dinject::New<MyObject>("myobj",config);
+    assert( obj->a == 3 );
+    assert( obj->str == "vector" );
+  }
+
   std::cout<<"tests passed\n";
   return 0;
 }
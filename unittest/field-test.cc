@@ -0,0 +1,115 @@
+#include "dinject.h"
+#include "plan.h"
+
+#include <iostream>
+#include <cstdint>
+#include <string>
+
+struct Stat {
+  std::int32_t str;
+  std::int32_t dex;
+  std::int32_t vit;
+  float crit;
+};
+
+DINJECT_CLASS(Stat) {
+  dinject::Class<Stat>("stat")
+    .AddField<&Stat::str> ("str")
+    .AddField<&Stat::dex> ("dex")
+    .AddField<&Stat::vit> ("vit")
+    .AddField<&Stat::crit>("crit");
+}
+
+// Mix of fields and setters
+struct Hero {
+  std::int64_t hp;
+  bool flying;
+  std::uint8_t level;
+  double speed;
+  std::string name;
+  std::string title;
+  Stat stat;
+
+  Hero() : hp(), flying(), level(), speed(), name(), title(), stat() {}
+
+  void SetTitle( const std::string& v ) { title = "sir " + v; }
+  Stat* GetStat()                       { return &stat; }
+};
+
+DINJECT_CLASS(Hero) {
+  dinject::Class<Hero>("hero")
+    .AddField<&Hero::hp>    ("hp")
+    .AddField<&Hero::flying>("flying")
+    .AddField<&Hero::level> ("level")
+    .AddField<&Hero::speed> ("speed")
+    .AddField<&Hero::name>  ("name")
+    .AddString              ("title",&Hero::SetTitle)
+    .AddStruct<Stat>        ("stat","stat",&Hero::GetStat);
+}
+
+static void Check( const Hero& h ) {
+  assert( h.hp == 100 );
+  assert( h.flying );
+  assert( h.level == 7 );
+  assert( h.speed == 2.5 );
+  assert( h.name == "arthur" );
+  assert( h.title == "sir knight" );
+  assert( h.stat.str == 1 );
+  assert( h.stat.dex == 2 );
+  assert( h.stat.vit == 3 );
+  assert( h.stat.crit == 0.5f );
+}
+
+int main() {
+  auto stat = dinject::NewDefaultConfigObject();
+  stat->Set("str",dinject::Val(1));
+  stat->Set("dex",dinject::Val(2));
+  stat->Set("vit",dinject::Val(3));
+  stat->Set("crit",dinject::Val(0.5));
+
+  auto config = dinject::NewDefaultConfigObject();
+  config->Set("hp",dinject::Val(100));
+  config->Set("flying",dinject::Val(true));
+  config->Set("level",dinject::Val(7));
+  config->Set("speed",dinject::Val(2.5));
+  config->Set("name",dinject::Val("arthur"));
+  config->Set("title",dinject::Val("knight"));
+  config->Set("stat",dinject::Val(stat));
+
+  {
+    auto klass = dinject::detail::GetKlass("hero");
+    auto attr  = klass->ResolveAttribute("speed");
+    assert( attr->is_field() );
+    assert( attr->offset() == offsetof(Hero,speed) );
+    assert( attr->type() == dinject::detail::kTypeDouble );
+    assert( klass->ResolveAttribute("name")->type() ==
+            dinject::detail::kTypeString );
+    assert( !klass->ResolveAttribute("title")->is_field() );
+  }
+
+  {
+    auto h = dinject::New<Hero>("hero",*config);
+    Check(*h);
+  }
+
+  {
+    dinject::Plan plan("hero",*config);
+    auto h = plan.New<Hero>();
+    Check(*h);
+
+    // the stat fields are adjacent and are merged into one copy
+    dinject::Plan sp("stat",*stat);
+    assert( sp.size() == 1 );
+    auto s = sp.New<Stat>();
+    assert( s->str == 1 && s->dex == 2 && s->vit == 3 && s->crit == 0.5f );
+  }
+
+  {
+    auto batch = dinject::NewBatch<Hero>("hero",*config,4);
+    assert( batch.size() == 4 );
+    for( auto &h : batch ) Check(*h);
+  }
+
+  std::cout<<"tests passed\n";
+  return 0;
+}
@@ -0,0 +1,142 @@
+#include "dinject.h"
+#include "flat.h"
+#include "plan.h"
+
+#include <iostream>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct Weapon {
+  std::int64_t damage;
+  std::string name;
+
+  Weapon() : damage(), name() {}
+
+  void SetDamage( std::int64_t v )      { damage = v; }
+  void SetName  ( const std::string& v ) { name = v; }
+};
+
+DINJECT_CLASS(Weapon) {
+  dinject::Class<Weapon>("weapon")
+    .AddPrimitive<std::int64_t>("damage",&Weapon::SetDamage)
+    .AddString                 ("name",&Weapon::SetName);
+}
+
+struct Soldier {
+  std::int64_t hp;
+  std::unique_ptr<Weapon> weapon;
+
+  Soldier() : hp(), weapon() {}
+
+  void SetHp    ( std::int64_t v ) { hp = v; }
+  void SetWeapon( Weapon* v )      { weapon.reset(v); }
+};
+
+DINJECT_CLASS(Soldier) {
+  dinject::Class<Soldier>("soldier")
+    .AddPrimitive<std::int64_t>("hp",&Soldier::SetHp)
+    .AddObject<Weapon>         ("weapon","weapon",&Soldier::SetWeapon);
+}
+
+// Collect keys in visiting order
+struct KeyCollector : public dinject::ConfigObject::Visitor {
+  std::vector<std::string> keys;
+  virtual void Visit( std::string_view key , dinject::Symbol ,
+                                             const dinject::ConfigValue& ) {
+    keys.emplace_back(key);
+  }
+};
+
+int main() {
+  dinject::Freeze();
+
+  // Set keeps the same order and semantic as the default config object
+  {
+    auto flat = dinject::NewFlatConfigObject();
+    auto map  = dinject::NewDefaultConfigObject();
+    const char* keys[] = { "b" , "a" , "a_very_long_key_name_over_inline" ,
+                           "c" , "a" , "" };
+    for( int i = 0 ; i < 6 ; ++i ) {
+      flat->Set(keys[i],dinject::Val(i));
+      map->Set (keys[i],dinject::Val(i));
+    }
+    assert( flat->size() == 5 );
+    assert( std::get<std::int64_t>(*flat->Get("a")) == 4 );
+    assert( std::get<std::int64_t>(
+          *flat->Get("a_very_long_key_name_over_inline")) == 2 );
+    assert( flat->Get("") );
+    assert( !flat->Get("d") );
+
+    KeyCollector l , r;
+    flat->ForEach(&l);
+    map->ForEach (&r);
+    assert( l.keys == r.keys );
+
+    std::vector<std::string> order;
+    for( auto itr(flat->NewIterator()) ; itr->HasNext() ; itr->Next() ) {
+      std::string key;
+      dinject::ConfigValue val;
+      itr->Get(&key,&val);
+      order.push_back(key);
+    }
+    assert( order == r.keys );
+  }
+
+  // bulk construction , last duplicate wins and the hash index is used
+  {
+    auto flat = dinject::NewFlatConfigObject();
+    const int kSize = 1000;
+    flat->Reserve(kSize + 1);
+    for( int i = kSize - 1 ; i >= 0 ; --i ) {
+      flat->Append("key" + std::to_string(i),dinject::Val(i));
+    }
+    flat->Append("key7",dinject::Val(-7));
+    assert( !flat->sealed() );
+    flat->Seal();
+    assert( flat->sealed() );
+    assert( flat->size() == kSize );
+
+    for( int i = 0 ; i < kSize ; ++i ) {
+      auto v = flat->Get("key" + std::to_string(i));
+      assert( v && std::get<std::int64_t>(*v) == (i == 7 ? -7 : i) );
+    }
+    assert( !flat->Get("key1000") );
+    for( std::size_t i = 1 ; i < flat->size() ; ++i ) {
+      assert( flat->key(i-1) < flat->key(i) );
+    }
+
+    // Set on an indexed object
+    flat->Set("key1000",dinject::Val(1000));
+    flat->Set("aaa",dinject::Val(1));
+    assert( std::get<std::int64_t>(*flat->Get("key1000")) == 1000 );
+    assert( std::get<std::int64_t>(*flat->Get("key999")) == 999 );
+    assert( flat->key(0) == "aaa" );
+  }
+
+  // build objects through New and Plan
+  {
+    auto weapon = dinject::NewFlatConfigObject();
+    weapon->Append("name",dinject::Val("axe"));
+    weapon->Append("damage",dinject::Val(12));
+    weapon->Seal();
+
+    auto soldier = dinject::NewFlatConfigObject();
+    soldier->Append("weapon",dinject::Val(weapon));
+    soldier->Append("hp",dinject::Val(100));
+    soldier->Append("unknown",dinject::Val(true));
+    soldier->Seal();
+
+    auto a = dinject::New<Soldier>("soldier",*soldier);
+    assert( a->hp == 100 );
+    assert( a->weapon && a->weapon->damage == 12 );
+    assert( a->weapon->name == "axe" );
+
+    dinject::Plan plan("soldier",*soldier);
+    auto b = plan.New<Soldier>();
+    assert( b->hp == 100 && b->weapon->name == "axe" );
+  }
+
+  std::cout<<"tests passed\n";
+  return 0;
+}
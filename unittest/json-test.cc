@@ -0,0 +1,248 @@
+#include "dinject.h"
+#include "json.h"
+#include "death.h"
+
+#include <iostream>
+#include <sstream>
+#include <cstdint>
+#include <string>
+
+struct Color {
+  std::int32_t r;
+  std::int32_t g;
+  std::int32_t b;
+
+  Color() : r(), g(), b() {}
+
+  void SetR( std::int32_t v ) { r = v; }
+  void SetG( std::int32_t v ) { g = v; }
+  void SetB( std::int32_t v ) { b = v; }
+};
+
+DINJECT_CLASS(Color) {
+  dinject::Class<Color>("color")
+    .AddPrimitive<std::int32_t>("r",&Color::SetR)
+    .AddPrimitive<std::int32_t>("g",&Color::SetG)
+    .AddPrimitive<std::int32_t>("b",&Color::SetB);
+}
+
+struct Light {
+  double intensity;
+  std::string name;
+
+  Light() : intensity(), name() {}
+
+  void SetIntensity( double v )         { intensity = v; }
+  void SetName     ( const std::string& v ) { name = v; }
+};
+
+DINJECT_CLASS(Light) {
+  dinject::Class<Light>("light")
+    .AddPrimitive<double>("intensity",&Light::SetIntensity)
+    .AddString           ("name",&Light::SetName);
+}
+
+struct Scene {
+  std::int64_t id;
+  bool visible;
+  double scale;
+  std::string title;
+  Color ambient;
+  std::unique_ptr<Light> light;
+
+  Scene() : id(), visible(), scale(), title(), ambient(), light() {}
+
+  void SetId     ( std::int64_t v )  { id = v; }
+  void SetVisible( bool v )          { visible = v; }
+  void SetScale  ( double v )        { scale = v; }
+  void SetTitle  ( std::string&& v ) { title = std::move(v); }
+  void SetLight  ( Light* v )        { light.reset(v); }
+  Color* GetAmbient()                { return &ambient; }
+};
+
+DINJECT_CLASS(Scene) {
+  dinject::Class<Scene>("scene")
+    .AddPrimitive<std::int64_t>("id",&Scene::SetId)
+    .AddPrimitive<bool>        ("visible",&Scene::SetVisible)
+    .AddPrimitive<double>      ("scale",&Scene::SetScale)
+    .AddString                 ("title",&Scene::SetTitle)
+    .AddStruct<Color>          ("ambient","color",&Scene::GetAmbient)
+    .AddObject<Light>          ("light","light",&Scene::SetLight);
+}
+
+static const char* kScene = R"({
+  "id"      : 42,
+  "visible" : true,
+  "scale"   : 1.5e1,
+  "title"   : "caf\u00e9 \"night\"\n\ud83d\ude00",
+  "unknown" : { "a" : [1, 2, {"b" : null}], "c" : "x" },
+  "tags"    : [ "a", "b" ],
+  "ambient" : { "r" : 1, "g" : 2, "b" : 3 },
+  "light"   : { "intensity" : -0.25, "name" : "sun" },
+  "nothing" : null
+})";
+
+static void Check( const Scene& s ) {
+  assert( s.id == 42 );
+  assert( s.visible );
+  assert( s.scale == 15.0 );
+  assert( s.title == "caf\xc3\xa9 \"night\"\n\xf0\x9f\x98\x80" );
+  assert( s.ambient.r == 1 && s.ambient.g == 2 && s.ambient.b == 3 );
+  assert( s.light );
+  assert( s.light->intensity == -0.25 );
+  assert( s.light->name == "sun" );
+}
+
+int main() {
+  {
+    std::string error;
+    auto s = dinject::NewFromJson<Scene>("scene",kScene,&error);
+    assert( s );
+    assert( error.empty() );
+    Check(*s);
+  }
+
+  // stream input
+  {
+    std::istringstream input(kScene);
+    auto s = dinject::NewFromJson<Scene>("scene",input);
+    assert( s );
+    Check(*s);
+  }
+
+  // a string longer than one chunk of the stream reader
+  {
+    std::string title(200000,'x');
+    std::istringstream input("{\"title\":\"" + title + "\",\"id\":7}");
+    auto s = dinject::NewFromJson<Scene>("scene",input);
+    assert( s );
+    assert( s->title == title );
+    assert( s->id == 7 );
+  }
+
+  // an integer literal is accepted by a double attribute
+  {
+    const char* json = "{\"scale\":15,\"light\":{\"intensity\":-2}}";
+    auto s = dinject::NewFromJson<Scene>("scene",json);
+    assert( s );
+    assert( s->scale == 15.0 );
+    assert( s->light->intensity == -2.0 );
+
+    auto lazy = dinject::NewLazyJsonConfigObject(json);
+    assert( std::get<std::int64_t>(*lazy->Get("scale")) == 15 );
+    s = dinject::New<Scene>("scene",*lazy);
+    assert( s->scale == 15.0 );
+    assert( s->light->intensity == -2.0 );
+  }
+
+  // syntax errors are reported and nothing leaks
+  {
+    const char* bad[] = {
+      "",
+      "[]",
+      "{",
+      "{\"id\" 1}",
+      "{\"id\":1,}",
+      "{\"title\":\"abc}",
+      "{\"light\":{\"name\":\"x\"}",
+      "{\"id\":1} x",
+      "{\"id\":tru}",
+      "{\"id\":-}",
+      "{\"title\":\"\\q\"}"
+    };
+    for( auto json : bad ) {
+      std::string error;
+      assert( !dinject::NewFromJson<Scene>("scene",json,&error) );
+      assert( !error.empty() );
+    }
+
+    std::string error;
+    assert( !dinject::NewFromJson<Scene>("no-such-class","{}",&error) );
+    assert( !error.empty() );
+  }
+
+  {
+    std::string deep;
+    for( int i = 0 ; i < 10000 ; ++i ) deep += "[";
+    std::string error;
+    assert( !dinject::NewFromJson<Scene>("scene","{\"x\":" + deep,&error) );
+    assert( !error.empty() );
+  }
+
+  // lazy config object
+  {
+    std::string error;
+    auto lazy = dinject::NewLazyJsonConfigObject(kScene,&error);
+    assert( lazy );
+    Check(*dinject::New<Scene>("scene",*lazy));
+
+    assert( std::get<std::int64_t>(*lazy->Get("id")) == 42 );
+    assert( std::get<double>(*lazy->Get("scale")) == 15.0 );
+    assert( !lazy->Get("tags") );      // array is dropped
+    assert( !lazy->Get("nothing") );   // null is dropped
+    assert( !lazy->Get("none") );
+
+    auto &light = std::get<std::shared_ptr<dinject::ConfigObject>>(
+        *lazy->Get("light"));
+    assert( std::get<std::string>(*light->Get("name")) == "sun" );
+    assert( lazy->Get("light") == lazy->Get(std::string("light")) );
+
+    // unwanted keys are never visited
+    struct Counter : public dinject::ConfigObject::Visitor {
+      int visit = 0;
+      virtual void Visit( std::string_view , dinject::Symbol ,
+                          const dinject::ConfigValue& ) { ++visit; }
+      virtual bool Wants( std::string_view key , dinject::Symbol ) {
+        return key == "id" || key == "ambient";
+      }
+    } counter;
+    lazy->ForEach(&counter);
+    assert( counter.visit == 2 );
+
+    std::size_t count = 0;
+    for( auto itr(lazy->NewIterator()) ; itr->HasNext() ; itr->Next() )
+      ++count;
+    assert( count == 7 );
+
+    lazy->Set("id",dinject::Val(1));
+    lazy->Set("scale",dinject::Val(2.0));
+    lazy->Set("fresh",dinject::Val("new"));
+    auto s = dinject::New<Scene>("scene",*lazy);
+    assert( s->id == 1 && s->scale == 2.0 && s->light->name == "sun" );
+    assert( std::get<std::string>(*lazy->Get("fresh")) == "new" );
+
+    assert( dinject::NewLazyJsonConfigObject("{}") );
+    assert( !dinject::NewLazyJsonConfigObject("{\"a\":{\"b\":1}",&error) );
+    assert( !dinject::NewLazyJsonConfigObject("[1]",&error) );
+    assert( !dinject::NewLazyJsonConfigObject("{} {}",&error) );
+    assert( !dinject::NewLazyJsonConfigObject("{\"a\":tru}",&error) );
+    assert( !dinject::NewLazyJsonConfigObject("{\"a\":-}",&error) );
+    assert( !dinject::NewLazyJsonConfigObject("{\"a\":1 \"b\":2}",&error) );
+    assert( !dinject::NewLazyJsonConfigObject("{\"a\":{\"b\":[1,}}",&error) );
+  }
+
+  // only the top level is checked up front , a nested section is lexed when
+  // it is reached so a broken one nobody reads costs nothing
+  {
+    std::string error;
+    auto lazy = dinject::NewLazyJsonConfigObject(
+        "{\"id\":3,\"junk\":{\"a\":tru,\"b\":[1,,\"]\"]},\"bad\":\"\\q\"}",
+        &error);
+    assert( lazy && error.empty() );
+    assert( std::get<std::int64_t>(*lazy->Get("id")) == 3 );
+    assert( dinject::New<Scene>("scene",*lazy)->id == 3 );
+
+    auto output = test::Aborts([&]() {
+      lazy->Get("junk");      // only indexed on first access
+      lazy->Get("bad");
+    });
+    assert( output.find("invalid escape") != std::string::npos );
+    auto &junk = std::get<std::shared_ptr<dinject::ConfigObject>>(
+        *lazy->Get("junk"));
+    output = test::Aborts([&]() { junk->Get("a"); });
+    assert( output.find("invalid literal") != std::string::npos );
+  }
+
+  std::cout<<"tests passed\n";
+  return 0;
+}
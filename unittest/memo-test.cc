@@ -0,0 +1,134 @@
+#include "dinject.h"
+#include "memo.h"
+
+#include <iostream>
+#include <cstdint>
+#include <string>
+
+static int kMaterialBuilt = 0;
+static int kShaderBuilt   = 0;
+
+struct Material {
+  std::string texture;
+  double roughness;
+
+  Material() : texture(), roughness() {}
+
+  void SetTexture  ( const std::string& v ) { ++kMaterialBuilt; texture = v; }
+  void SetRoughness( double v )             { roughness = v; }
+};
+
+DINJECT_CLASS(Material) {
+  dinject::Class<Material>("material")
+    .AddString        ("texture",&Material::SetTexture)
+    .AddPrimitive<double>("roughness",&Material::SetRoughness)
+    .Memoize();
+}
+
+struct Shader {
+  std::string source;
+
+  Shader() : source() {}
+
+  void SetSource( const std::string& v ) { ++kShaderBuilt; source = v; }
+};
+
+DINJECT_CLASS(Shader) {
+  dinject::Class<Shader>("shader")
+    .AddString("source",&Shader::SetSource)
+    .Immutable();
+}
+
+struct Mesh {
+  std::unique_ptr<Material> material;
+  std::shared_ptr<Shader> shader;
+  std::int64_t lod;
+
+  Mesh() : material(), shader(), lod() {}
+
+  void SetMaterial( Material* v )              { material.reset(v); }
+  void SetShader  ( std::shared_ptr<Shader> v ) { shader = std::move(v); }
+  void SetLod     ( std::int64_t v )            { lod = v; }
+};
+
+DINJECT_CLASS(Mesh) {
+  dinject::Class<Mesh>("mesh")
+    .AddObject<Material>    ("material","material",&Mesh::SetMaterial)
+    .AddShared<Shader>      ("shader","shader",&Mesh::SetShader)
+    .AddPrimitive<std::int64_t>("lod",&Mesh::SetLod);
+}
+
+static std::shared_ptr<dinject::ConfigObject> NewMesh( const char* texture ,
+                                                       std::int64_t lod ) {
+  auto material = dinject::NewDefaultConfigObject();
+  material->Set("texture",dinject::Val(texture));
+  material->Set("roughness",dinject::Val(0.5));
+
+  auto shader = dinject::NewDefaultConfigObject();
+  shader->Set("source",dinject::Val("void main() {}"));
+
+  auto mesh = dinject::NewDefaultConfigObject();
+  mesh->Set("material",dinject::Val(material));
+  mesh->Set("shader",dinject::Val(shader));
+  mesh->Set("lod",dinject::Val(lod));
+  return mesh;
+}
+
+int main() {
+  dinject::Freeze();
+
+  {
+    dinject::MemoCache memo(1024 * 1024);
+    auto a = dinject::New<Mesh>("mesh",*NewMesh("rock.png",0),memo);
+    auto b = dinject::New<Mesh>("mesh",*NewMesh("rock.png",1),memo);
+    auto c = dinject::New<Mesh>("mesh",*NewMesh("tree.png",2),memo);
+
+    // identical material is copied , identical shader is shared
+    assert( kMaterialBuilt == 2 );
+    assert( kShaderBuilt == 1 );
+    assert( a->material && b->material && a->material != b->material );
+    assert( b->material->texture == "rock.png" );
+    assert( b->material->roughness == 0.5 );
+    assert( c->material->texture == "tree.png" );
+    assert( a->shader == b->shader && b->shader == c->shader );
+    assert( a->lod == 0 && b->lod == 1 && c->lod == 2 );
+
+    auto stats = memo.stats();
+    assert( stats.hit == 3 );
+    assert( stats.miss == 3 );
+    assert( stats.count == 3 );
+    assert( stats.evict == 0 );
+    assert( stats.bytes > 0 && stats.bytes <= memo.capacity() );
+
+    memo.Clear();
+    assert( memo.stats().count == 0 && memo.stats().bytes == 0 );
+    auto d = dinject::New<Mesh>("mesh",*NewMesh("rock.png",0),memo);
+    assert( kMaterialBuilt == 3 );
+  }
+
+  // without a MemoCache everything is built
+  {
+    kMaterialBuilt = kShaderBuilt = 0;
+    auto a = dinject::New<Mesh>("mesh",*NewMesh("rock.png",0));
+    auto b = dinject::New<Mesh>("mesh",*NewMesh("rock.png",0));
+    assert( kMaterialBuilt == 2 && kShaderBuilt == 2 );
+    assert( a->shader != b->shader );
+  }
+
+  // the capacity evicts least recently used entries
+  {
+    dinject::MemoCache memo(400);
+    for( int i = 0 ; i < 16 ; ++i ) {
+      auto texture = "texture" + std::to_string(i);
+      auto m = dinject::New<Mesh>("mesh",*NewMesh(texture.c_str(),0),memo);
+      assert( m->material->texture == texture );
+    }
+    auto stats = memo.stats();
+    assert( stats.bytes <= 400 );
+    assert( stats.evict > 0 );
+    assert( stats.count + stats.evict == 17 );
+  }
+
+  std::cout<<"tests passed\n";
+  return 0;
+}
@@ -0,0 +1,148 @@
+#include "dinject.h"
+
+#include <iostream>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+struct Base {
+  std::int32_t v;
+  Base() : v() {}
+  void Set( std::int32_t x ) { v = x; }
+};
+
+struct Middle {
+  std::int32_t v;
+  Middle() : v() {}
+  void Set( std::int32_t x ) { v = x; }
+};
+
+struct Leaf {
+  std::int32_t v;
+  Leaf() : v() {}
+  void Set( std::int32_t x ) { v = x; }
+};
+
+// names need to outlive the registration
+static std::string kNames[48];
+
+DINJECT_CLASS(Base) {
+  for( int i = 0 ; i < 48 ; ++i ) kNames[i] = "attr" + std::to_string(i);
+
+  auto& klass = dinject::Class<Base>("base");
+  for( int i = 0 ; i < 16 ; ++i )
+    klass.AddPrimitive<std::int32_t>(kNames[i].c_str(),&Base::Set);
+  klass.AddPrimitive<std::int32_t>("shadow",&Base::Set);
+}
+
+DINJECT_CLASS(Middle) {
+  auto& klass = dinject::Class<Middle>("middle").Inherit("base");
+  for( int i = 16 ; i < 32 ; ++i )
+    klass.AddPrimitive<std::int32_t>(kNames[i].c_str(),&Middle::Set);
+  klass.AddPrimitive<std::int32_t>("shadow",&Middle::Set);
+}
+
+DINJECT_CLASS(Leaf) {
+  auto& klass = dinject::Class<Leaf>("leaf").Inherit("middle");
+  for( int i = 32 ; i < 48 ; ++i )
+    klass.AddPrimitive<std::int32_t>(kNames[i].c_str(),&Leaf::Set);
+}
+
+int main() {
+  auto leaf   = dinject::detail::GetKlass("leaf");
+  auto middle = dinject::detail::GetKlass("middle");
+  assert( leaf && middle );
+
+  // every attribute in the hierarchy is visible from the leaf
+  for( int i = 0 ; i < 48 ; ++i ) {
+    auto attr = leaf->ResolveAttribute(kNames[i].c_str());
+    assert( attr );
+    assert( kNames[i] == attr->name() );
+  }
+  assert( leaf->sealed() );
+
+  // own attributes are not merged into parents
+  assert( !middle->ResolveAttribute("attr40") );
+  assert( middle->ResolveAttribute("attr3") );
+
+  // nearest declaration shadows the one in parents
+  assert( leaf->ResolveAttribute("shadow") ==
+          middle->FindAttribute("shadow") );
+  assert( leaf->ResolveAttribute("shadow") !=
+          dinject::detail::GetKlass("base")->FindAttribute("shadow") );
+
+  assert( !leaf->ResolveAttribute("attr48") );
+  assert( !leaf->ResolveAttribute("") );
+
+  // registration after sealing invalidates the table
+  dinject::Class<Base>("late").AddPrimitive<std::int32_t>("late",&Base::Set);
+  assert( !leaf->sealed() );
+  dinject::detail::GetKlass("base")->Seal();
+  assert( !leaf->ResolveAttribute("late") );
+  assert( leaf->sealed() );
+
+  // names are interned at registration
+  {
+    auto symbol = dinject::FindSymbol("leaf");
+    assert( symbol != dinject::kNoSymbol );
+    assert( symbol == leaf->symbol() );
+    assert( dinject::Intern("leaf") == symbol );
+    assert( std::strcmp(dinject::GetSymbolName(symbol),"leaf") == 0 );
+    assert( dinject::detail::GetKlass(symbol) == leaf );
+    assert( dinject::FindSymbol("never-registered") == dinject::kNoSymbol );
+    assert( !dinject::GetSymbolName(dinject::kNoSymbol) );
+
+    for( int i = 0 ; i < 48 ; ++i ) {
+      auto s = dinject::FindSymbol(kNames[i]);
+      assert( s != dinject::kNoSymbol );
+      assert( leaf->ResolveAttribute(s) ==
+              leaf->ResolveAttribute(kNames[i].c_str()) );
+    }
+    assert( !middle->ResolveAttribute(dinject::FindSymbol("attr40")) );
+    assert( !leaf->ResolveAttribute(dinject::kNoSymbol) );
+  }
+
+  // every registered C++ type gets a distinct TypeId
+  {
+    using dinject::detail::ObjectRef;
+    using dinject::detail::GetTypeId;
+    assert( leaf->type_id() == GetTypeId<Leaf>() );
+    assert( middle->type_id() == GetTypeId<Middle>() );
+    assert( leaf->type_id() != middle->type_id() );
+    assert( leaf->type_id() != dinject::detail::kNoTypeId );
+
+    Leaf l;
+    auto ref = ObjectRef::Of(&l);
+    assert( ref.As<Leaf>() == &l );
+    assert( !ref.As<Middle>() );
+    assert( !ObjectRef().As<Leaf>() );
+  }
+
+  // the attribute resolved in Wants is reused once by Visit of the same key
+  {
+    std::string key("attr40");
+    auto attr = leaf->ResolveAttribute(std::string_view(key));
+    dinject::detail::WantedAttribute wanted;
+    dinject::detail::Attribute* output = NULL;
+    assert( !wanted.Take(key,dinject::kNoSymbol,&output) );
+    assert( wanted.Set(key,dinject::kNoSymbol,attr) == attr );
+    assert( !wanted.Take(std::string("attr40"),dinject::kNoSymbol,&output) );
+    assert( !wanted.Take(key,dinject::FindSymbol("attr40"),&output) );
+    assert( wanted.Take(key,dinject::kNoSymbol,&output) && output == attr );
+    assert( !wanted.Take(key,dinject::kNoSymbol,&output) );
+
+    // an unwanted key is cached as well
+    wanted.Set(key,dinject::kNoSymbol,NULL);
+    assert( wanted.Take(key,dinject::kNoSymbol,&output) && !output );
+  }
+
+  // building through the flattened table works as usual
+  auto config = dinject::NewDefaultConfigObject();
+  config->Set("attr40",dinject::Val(7));
+  config->Set("attr47",dinject::Val(9));
+  auto obj = dinject::New<Leaf>("leaf",*config);
+  assert( obj->v == 7 || obj->v == 9 );
+
+  std::cout<<"tests passed\n";
+  return 0;
+}
@@ -0,0 +1,129 @@
+#include "dinject.h"
+#include "executor.h"
+
+#include <iostream>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct Curve {
+  double scale;
+
+  Curve() : scale() {}
+
+  void SetScale( double v ) { scale = v; }
+};
+
+DINJECT_CLASS(Curve) {
+  dinject::Class<Curve>("curve")
+    .AddPrimitive<double>("scale",&Curve::SetScale);
+}
+
+struct Emitter {
+  std::int64_t id;
+  std::uint64_t checksum;
+  std::unique_ptr<Curve> curve;
+
+  Emitter() : id(), checksum(), curve() {}
+
+  // do some real work so there is something to parallelize
+  void SetId( std::int64_t v ) {
+    id = v;
+    std::uint64_t h = static_cast<std::uint64_t>(v);
+    for( int i = 0 ; i < 10000 ; ++i ) h = h * 31 + i;
+    checksum = h;
+  }
+  void SetCurve( Curve* v ) { curve.reset(v); }
+};
+
+DINJECT_CLASS(Emitter) {
+  dinject::Class<Emitter>("emitter")
+    .AddPrimitive<std::int64_t>("id",&Emitter::SetId)
+    .AddObject<Curve>          ("curve","curve",&Emitter::SetCurve);
+}
+
+static const int kEmitter = 64;
+static std::string kKeys[kEmitter];
+
+struct World {
+  std::string name;
+  std::vector<std::unique_ptr<Emitter>> emitters;
+  std::vector<std::string> order;   // order of setter invocation
+
+  World() : name(), emitters(), order() {}
+
+  void SetName( const std::string& v ) {
+    name = v;
+    order.push_back("name");
+  }
+  void AddEmitter( Emitter* e ) {
+    emitters.emplace_back(e);
+    order.push_back(std::to_string(e->id));
+  }
+};
+
+DINJECT_CLASS(World) {
+  auto &klass = dinject::Class<World>("world")
+    .AddString("name",&World::SetName);
+  for( int i = 0 ; i < kEmitter ; ++i ) {
+    kKeys[i] = "emitter" + std::to_string(i);
+    klass.AddObject<Emitter>(kKeys[i].c_str(),"emitter",&World::AddEmitter);
+  }
+}
+
+int main() {
+  dinject::Freeze();
+
+  auto world = dinject::NewDefaultConfigObject();
+  world->Set("name",dinject::Val("world"));
+  for( int i = 0 ; i < kEmitter ; ++i ) {
+    auto curve = dinject::NewDefaultConfigObject();
+    curve->Set("scale",dinject::Val(i * 0.5));
+
+    auto emitter = dinject::NewDefaultConfigObject();
+    emitter->Set("id",dinject::Val(i));
+    emitter->Set("curve",dinject::Val(curve));
+    world->Set(kKeys[i],dinject::Val(emitter));
+  }
+
+  auto serial = dinject::New<World>("world",*world);
+  assert( serial->emitters.size() == kEmitter );
+
+  for( std::size_t thread : { 1 , 3 , 8 } ) {
+    dinject::ThreadPool pool(thread);
+    for( int loop = 0 ; loop < 5 ; ++loop ) {
+      auto parallel = dinject::NewParallel<World>("world",*world,pool);
+      assert( parallel );
+      assert( parallel->name == "world" );
+      assert( parallel->order == serial->order );
+      assert( parallel->emitters.size() == kEmitter );
+      for( std::size_t i = 0 ; i < parallel->emitters.size() ; ++i ) {
+        auto &a = *parallel->emitters[i];
+        auto &b = *serial->emitters[i];
+        assert( a.id == b.id );
+        assert( a.checksum == b.checksum );
+        assert( a.curve && a.curve->scale == a.id * 0.5 );
+      }
+    }
+  }
+
+  // task group can be nested and waited from workers
+  {
+    dinject::ThreadPool pool(4);
+    std::atomic<int> count(0);
+    dinject::TaskGroup outer(&pool);
+    for( int i = 0 ; i < 16 ; ++i ) {
+      outer.Run([&]() {
+        dinject::TaskGroup inner(&pool);
+        for( int j = 0 ; j < 16 ; ++j ) inner.Run([&]() { ++count; });
+        inner.Wait();
+      });
+    }
+    outer.Wait();
+    assert( count == 256 );
+  }
+
+  std::cout<<"tests passed\n";
+  return 0;
+}
@@ -0,0 +1,174 @@
+#include "dinject.h"
+#include "plan.h"
+#include "death.h"
+
+#include <iostream>
+#include <cstdint>
+#include <string>
+
+struct Weapon {
+  std::int32_t damage;
+  std::string name;
+
+  Weapon() : damage(), name() {}
+
+  void SetDamage( std::int32_t v )     { damage = v; }
+  void SetName  ( const std::string& v ) { name = v; }
+};
+
+DINJECT_CLASS(Weapon) {
+  dinject::Class<Weapon>("weapon")
+    .AddPrimitive<std::int32_t>("damage",&Weapon::SetDamage)
+    .AddString                 ("name"  ,&Weapon::SetName);
+}
+
+struct Position {
+  double x;
+  double y;
+
+  Position() : x(), y() {}
+
+  void SetX( double v ) { x = v; }
+  void SetY( double v ) { y = v; }
+};
+
+DINJECT_CLASS(Position) {
+  dinject::Class<Position>("position")
+    .AddPrimitive<double>("x",&Position::SetX)
+    .AddPrimitive<double>("y",&Position::SetY);
+}
+
+struct Monster {
+  std::int64_t hp;
+  bool boss;
+  std::string tag;
+  Position pos;
+  std::unique_ptr<Weapon> weapon;
+
+  Monster() : hp(), boss(), tag(), pos(), weapon() {}
+
+  void SetHp    ( std::int64_t v )  { hp = v; }
+  void SetBoss  ( bool v )          { boss = v; }
+  void SetTag   ( std::string&& v ) { tag = std::move(v); }
+  void SetWeapon( Weapon* v )       { weapon.reset(v); }
+  Position* GetPos()                { return &pos; }
+};
+
+DINJECT_CLASS(Monster) {
+  dinject::Class<Monster>("monster")
+    .AddPrimitive<std::int64_t>("hp",&Monster::SetHp)
+    .AddPrimitive<bool>  ("boss"  ,&Monster::SetBoss)
+    .AddString           ("tag"   ,&Monster::SetTag)
+    .AddStruct<Position> ("pos"   ,"position",&Monster::GetPos)
+    .AddObject<Weapon>   ("weapon","weapon",&Monster::SetWeapon);
+}
+
+int main() {
+  auto config = dinject::NewDefaultConfigObject();
+  config->Set("hp",dinject::Val(100));
+  config->Set("boss",dinject::Val(true));
+  config->Set("tag",dinject::Val("orc"));
+  config->Set("unknown",dinject::Val(1));
+
+  {
+    auto pos = dinject::NewDefaultConfigObject();
+    pos->Set("x",dinject::Val(1.5));
+    pos->Set("y",dinject::Val(2.5));
+    config->Set("pos",dinject::Val(pos));
+  }
+
+  {
+    auto weapon = dinject::NewDefaultConfigObject();
+    weapon->Set("damage",dinject::Val(42));
+    weapon->Set("name",dinject::Val("axe"));
+    config->Set("weapon",dinject::Val(weapon));
+  }
+
+  dinject::Plan plan("monster",*config);
+  assert( plan.valid() );
+  assert( std::string(plan.name()) == "monster" );
+
+  // the plan doesn't depend on the config anymore
+  config->Set("hp",dinject::Val(1));
+
+  for( int i = 0 ; i < 3 ; ++i ) {
+    auto m = plan.New<Monster>();
+    assert( m->hp == 100 );
+    assert( m->boss );
+    assert( m->tag == "orc" );
+    assert( m->pos.x == 1.5 );
+    assert( m->pos.y == 2.5 );
+    assert( m->weapon );
+    assert( m->weapon->damage == 42 );
+    assert( m->weapon->name == "axe" );
+  }
+
+  // plan and New must agree with each other
+  {
+    auto m = dinject::New<Monster>("monster",*config);
+    assert( m->hp == 1 );
+    assert( m->weapon->damage == 42 );
+    assert( m->pos.y == 2.5 );
+  }
+
+  {
+    dinject::Plan missing("no-such-class",*config);
+    assert( !missing.valid() );
+    assert( !missing.New<Monster>() );
+  }
+
+  // batch creation shares the converted values between all instances
+  {
+    auto batch = dinject::NewBatch<Monster>("monster",*config,16);
+    assert( batch.size() == 16 );
+    for( auto &m : batch ) {
+      assert( m->hp == 1 );
+      assert( m->tag == "orc" );
+      assert( m->pos.x == 1.5 );
+      assert( m->weapon && m->weapon->name == "axe" );
+    }
+    assert( batch[0]->weapon.get() != batch[1]->weapon.get() );
+    assert( dinject::NewBatch<Monster>("no-such-class",*config,4).empty() );
+    assert( dinject::NewBatch<Weapon>("monster",*config,4).empty() );
+  }
+
+  {
+    const std::size_t kCount = 8;
+    alignas(Weapon) unsigned char buffer[sizeof(Weapon)*kCount];
+    auto weapons = reinterpret_cast<Weapon*>(buffer);
+    auto wcfg = dinject::NewDefaultConfigObject();
+    wcfg->Set("damage",dinject::Val(7));
+    wcfg->Set("name",dinject::Val("bow"));
+    assert( dinject::NewBatch<Weapon>("weapon",*wcfg,weapons,kCount) ==
+            kCount );
+    for( std::size_t i = 0 ; i < kCount ; ++i ) {
+      assert( weapons[i].damage == 7 );
+      assert( weapons[i].name == "bow" );
+      weapons[i].~Weapon();
+    }
+    assert( dinject::NewBatch<Monster>("weapon",*wcfg,
+          reinterpret_cast<Monster*>(buffer),0) == 0 );
+  }
+
+  // a mismatched value is rejected when the plan is compiled
+  {
+    auto bad_struct = dinject::NewDefaultConfigObject();
+    bad_struct->Set("pos",dinject::Val(5));
+    auto error = test::Aborts([&]() {
+      dinject::Plan bad("monster",*bad_struct);
+    });
+    assert( error.find("attribute pos expect type position") !=
+            std::string::npos );
+
+    auto bad_primitive = dinject::NewDefaultConfigObject();
+    bad_primitive->Set("hp",dinject::Val(dinject::NewDefaultConfigObject()));
+    error = test::Aborts([&]() {
+      dinject::Plan bad("monster",*bad_primitive);
+    });
+    assert( error.find("attribute hp expect type int64") !=
+            std::string::npos );
+  }
+
+  std::cout<<"tests passed\n";
+  return 0;
+}
@@ -0,0 +1,95 @@
+#include "dinject.h"
+#include "profile.h"
+
+#include <iostream>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+struct Engine {
+  std::int64_t power;
+
+  Engine() : power() {}
+
+  void SetPower( std::int64_t v ) { power = v; }
+};
+
+DINJECT_CLASS(Engine) {
+  dinject::Class<Engine>("engine")
+    .AddPrimitive<std::int64_t>("power",&Engine::SetPower);
+}
+
+struct Car {
+  std::string name;
+  std::unique_ptr<Engine> engine;
+
+  Car() : name(), engine() {}
+
+  void SetName  ( const std::string& v ) { name = v; }
+  void SetEngine( Engine* v )            { engine.reset(v); }
+};
+
+DINJECT_CLASS(Car) {
+  dinject::Class<Car>("car")
+    .AddString     ("name",&Car::SetName)
+    .AddObject<Engine>("engine","engine",&Car::SetEngine);
+}
+
+int main() {
+  dinject::Freeze();
+
+  auto engine = dinject::NewDefaultConfigObject();
+  engine->Set("power",dinject::Val(300));
+  engine->Set("colour",dinject::Val("red"));   // not an attribute
+
+  auto car = dinject::NewDefaultConfigObject();
+  car->Set("name",dinject::Val("coupe"));
+  car->Set("engine",dinject::Val(engine));
+
+  const int kCount = 100;
+  for( int i = 0 ; i < kCount ; ++i ) {
+    auto c = dinject::New<Car>("car",*car);
+    assert( c->engine->power == 300 );
+  }
+
+  dinject::KlassProfile profile;
+  if(!dinject::ProfileEnabled()) {
+    // compiled out , nothing is recorded
+    assert( dinject::GetProfile().empty() );
+    assert( !dinject::GetProfile("car",&profile) );
+    std::cout<<"tests passed\n";
+    return 0;
+  }
+
+  assert( dinject::GetProfile("car",&profile) );
+  assert( profile.name == "car" );
+  assert( profile.count == kCount );
+  assert( profile.setter_count == 2 * kCount );
+  assert( profile.miss == 0 );
+  assert( profile.build_ns > 0 );
+
+  std::uint64_t total = 0;
+  for( auto e : profile.histogram ) total += e;
+  assert( total == kCount );
+  assert( profile.Percentile(0.5) <= profile.Percentile(0.99) );
+
+  dinject::KlassProfile nested;
+  assert( dinject::GetProfile("engine",&nested) );
+  assert( nested.count == kCount );
+  assert( nested.setter_count == kCount );
+  assert( nested.miss == kCount );                // colour is ignored
+  assert( nested.build_ns <= profile.build_ns );  // car includes the engine
+
+  auto all = dinject::GetProfile();
+  assert( all.size() == 2 );
+  assert( all[0].name == "car" );
+
+  dinject::DumpProfile(stdout);
+
+  dinject::ResetProfile();
+  assert( !dinject::GetProfile("car",&profile) );
+  assert( dinject::GetProfile().empty() );
+
+  std::cout<<"tests passed\n";
+  return 0;
+}
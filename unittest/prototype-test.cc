@@ -0,0 +1,130 @@
+#include "dinject.h"
+#include "prototype.h"
+
+#include <iostream>
+#include <cstdint>
+#include <string>
+
+struct Stat {
+  std::int32_t armor;
+  double speed;
+
+  Stat() : armor(), speed() {}
+
+  void SetArmor( std::int32_t v ) { armor = v; }
+  void SetSpeed( double v )       { speed = v; }
+};
+
+DINJECT_CLASS(Stat) {
+  dinject::Class<Stat>("stat")
+    .AddPrimitive<std::int32_t>("armor",&Stat::SetArmor)
+    .AddPrimitive<double>      ("speed",&Stat::SetSpeed);
+}
+
+static int kSetterCount = 0;
+
+struct Orc {
+  std::int64_t hp;
+  std::string name;
+  Stat stat;
+
+  Orc() : hp(), name(), stat() {}
+
+  void SetHp  ( std::int64_t v )       { hp = v; ++kSetterCount; }
+  void SetName( const std::string& v ) { name = v; ++kSetterCount; }
+  Stat* GetStat()                      { return &stat; }
+};
+
+DINJECT_CLASS(Orc) {
+  dinject::Class<Orc>("orc")
+    .AddPrimitive<std::int64_t>("hp",&Orc::SetHp)
+    .AddString                 ("name",&Orc::SetName)
+    .AddStruct<Stat>           ("stat","stat",&Orc::GetStat);
+}
+
+// Not copyable since it owns its child
+struct Squad {
+  std::unique_ptr<Orc> leader;
+
+  Squad() : leader() {}
+
+  void SetLeader( Orc* v ) { leader.reset(v); }
+};
+
+DINJECT_CLASS(Squad) {
+  dinject::Class<Squad>("squad")
+    .AddObject<Orc>("leader","orc",&Squad::SetLeader);
+}
+
+int main() {
+  auto config = dinject::NewDefaultConfigObject();
+  config->Set("hp",dinject::Val(100));
+  config->Set("name",dinject::Val("grunt"));
+  {
+    auto stat = dinject::NewDefaultConfigObject();
+    stat->Set("armor",dinject::Val(5));
+    stat->Set("speed",dinject::Val(1.5));
+    config->Set("stat",dinject::Val(stat));
+  }
+
+  assert( dinject::RegisterPrototype<Orc>("grunt","orc",*config) );
+  assert( !dinject::RegisterPrototype<Orc>("ghost","no-such-class",*config) );
+  assert( kSetterCount == 2 );
+
+  // clone never goes through setters
+  for( int i = 0 ; i < 4 ; ++i ) {
+    auto orc = dinject::Clone<Orc>("grunt");
+    assert( orc );
+    assert( orc->hp == 100 );
+    assert( orc->name == "grunt" );
+    assert( orc->stat.armor == 5 );
+    assert( orc->stat.speed == 1.5 );
+  }
+  assert( kSetterCount == 2 );
+  assert( !dinject::Clone<Orc>("ghost") );
+
+  // overrides are applied with setters on top of the clone
+  {
+    auto overrides = dinject::NewDefaultConfigObject();
+    overrides->Set("hp",dinject::Val(250));
+    auto stat = dinject::NewDefaultConfigObject();
+    stat->Set("speed",dinject::Val(3.0));
+    overrides->Set("stat",dinject::Val(stat));
+
+    auto orc = dinject::Clone<Orc>("grunt",*overrides);
+    assert( orc->hp == 250 );
+    assert( orc->name == "grunt" );
+    assert( orc->stat.armor == 5 );
+    assert( orc->stat.speed == 3.0 );
+    assert( kSetterCount == 3 );
+
+    // the prototype itself is not touched
+    assert( dinject::Clone<Orc>("grunt")->hp == 100 );
+  }
+
+  // user supplied clone function for a type which is not copyable
+  {
+    auto squad = dinject::NewDefaultConfigObject();
+    squad->Set("leader",dinject::Val(config));
+    assert( dinject::RegisterPrototype<Squad>("squad","squad",*squad,
+          std::function<Squad* (const Squad&)>([](const Squad& that) {
+            auto s = new Squad();
+            if(that.leader) s->leader.reset(new Orc(*that.leader));
+            return s;
+          })) );
+
+    auto a = dinject::Clone<Squad>("squad");
+    auto b = dinject::Clone<Squad>("squad");
+    assert( a->leader && b->leader );
+    assert( a->leader.get() != b->leader.get() );
+    assert( a->leader->name == "grunt" );
+  }
+
+  // registering with the same name replaces the old prototype
+  config->Set("hp",dinject::Val(1));
+  assert( dinject::RegisterPrototype<Orc>("grunt","orc",*config) );
+  assert( dinject::Clone<Orc>("grunt")->hp == 1 );
+
+  std::cout<<"tests passed\n";
+  return 0;
+}
@@ -0,0 +1,220 @@
+#include "dinject.h"
+#include "reload.h"
+#include "death.h"
+
+#include <iostream>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+static int kLightBuilt = 0;
+
+struct Light {
+  double intensity;
+
+  Light() : intensity() { ++kLightBuilt; }
+
+  void SetIntensity( double v ) { intensity = v; }
+};
+
+DINJECT_CLASS(Light) {
+  dinject::Class<Light>("light")
+    .AddPrimitive<double>("intensity",&Light::SetIntensity);
+}
+
+struct Transform {
+  double x;
+  double y;
+  int set;       // number of setter invoked
+
+  Transform() : x(), y(), set() {}
+
+  void SetX( double v ) { x = v; ++set; }
+  void SetY( double v ) { y = v; ++set; }
+};
+
+DINJECT_CLASS(Transform) {
+  dinject::Class<Transform>("transform")
+    .AddPrimitive<double>("x",&Transform::SetX)
+    .AddPrimitive<double>("y",&Transform::SetY);
+}
+
+struct Ghost {};
+
+struct Room {
+  std::string name;
+  std::int64_t size;
+  Transform transform;
+  std::unique_ptr<Light> light;
+  std::unique_ptr<Light> lamp;
+  std::shared_ptr<Light> spot;
+  std::unique_ptr<Ghost> ghost;
+  int set;
+
+  Room() : name(), size(), transform(), light(), lamp(), spot(), ghost(),
+           set() {}
+
+  void SetName ( const std::string& v ) { name = v; ++set; }
+  void SetSize ( std::int64_t v )       { size = v; ++set; }
+  void SetLight( Light* v )             { light.reset(v); ++set; }
+  void SetLamp ( Light* v )             { lamp.reset(v); ++set; }
+  void SetSpot ( std::shared_ptr<Light> v ) { spot = std::move(v); ++set; }
+  void SetGhost( Ghost* v )             { ghost.reset(v); ++set; }
+  Transform* GetTransform()             { return &transform; }
+};
+
+DINJECT_CLASS(Room) {
+  dinject::Class<Room>("room")
+    .AddString                 ("name",&Room::SetName)
+    .AddPrimitive<std::int64_t>("size",&Room::SetSize)
+    .AddStruct<Transform>      ("transform","transform",&Room::GetTransform)
+    .AddObject<Light>          ("light","light",&Room::SetLight)
+    .AddObject<Light>          ("lamp","light",&Room::SetLamp)
+    .AddShared<Light>          ("spot","light",&Room::SetSpot)
+    .AddObject<Ghost>          ("ghost","ghost",&Room::SetGhost); // unknown
+}
+
+static std::shared_ptr<dinject::ConfigObject> NewLight( double intensity ) {
+  auto light = dinject::NewDefaultConfigObject();
+  light->Set("intensity",dinject::Val(intensity));
+  return light;
+}
+
+static std::shared_ptr<dinject::ConfigObject> NewRoom( double x ,
+                                                       double intensity ) {
+  auto transform = dinject::NewDefaultConfigObject();
+  transform->Set("x",dinject::Val(x));
+  transform->Set("y",dinject::Val(2.0));
+
+  auto room = dinject::NewDefaultConfigObject();
+  room->Set("name",dinject::Val("hall"));
+  room->Set("size",dinject::Val(10));
+  room->Set("transform",dinject::Val(transform));
+  room->Set("light",dinject::Val(NewLight(intensity)));
+  room->Set("lamp",dinject::Val(NewLight(0.25)));
+  return room;
+}
+
+int main() {
+  dinject::Freeze();
+
+  auto old_config = NewRoom(1.0,0.5);
+  auto room = dinject::New<Room>("room",*old_config);
+  assert( kLightBuilt == 2 );
+  room->set = 0;
+  room->transform.set = 0;
+
+  // nothing changed
+  std::size_t changed = 0;
+  assert( dinject::Apply(room.get(),"room",*old_config,*NewRoom(1.0,0.5),
+                         &changed) );
+  assert( changed == 0 );
+  assert( room->set == 0 && room->transform.set == 0 );
+  assert( kLightBuilt == 2 );
+
+  // one field of the struct and one nested object changed
+  auto new_config = NewRoom(3.0,0.75);
+  new_config->Set("size",dinject::Val(20));
+  auto lamp = room->lamp.get();
+  assert( dinject::Apply(room.get(),"room",*old_config,*new_config,
+                         &changed) );
+  assert( changed == 3 );
+  assert( room->size == 20 && room->set == 2 );
+  assert( room->transform.x == 3.0 && room->transform.set == 1 );
+  assert( room->light->intensity == 0.75 );
+  assert( room->lamp.get() == lamp );
+  assert( kLightBuilt == 3 );
+
+  // a key missing in the old config is applied , a removed key is kept
+  auto partial = dinject::NewDefaultConfigObject();
+  partial->Set("name",dinject::Val("hall"));
+  auto renamed = dinject::NewDefaultConfigObject();
+  renamed->Set("name",dinject::Val("kitchen"));
+  renamed->Set("size",dinject::Val(20));
+  assert( dinject::Apply(room.get(),"room",*partial,*renamed,&changed) );
+  assert( changed == 2 );
+  assert( room->name == "kitchen" );
+  assert( room->transform.x == 3.0 );
+
+  // a primitive for a struct attribute and a nested config for a primitive
+  // attribute are rejected before any setter is invoked
+  {
+    auto bad_struct = dinject::NewDefaultConfigObject();
+    bad_struct->Set("transform",dinject::Val(5));
+    auto error = test::Aborts([&]() {
+      dinject::Apply(room.get(),"room",*partial,*bad_struct);
+    });
+    assert( error.find("attribute transform expect type transform") !=
+            std::string::npos );
+
+    auto bad_primitive = dinject::NewDefaultConfigObject();
+    bad_primitive->Set("size",dinject::Val(NewRoom(1.0,0.5)));
+    error = test::Aborts([&]() {
+      dinject::Apply(room.get(),"room",*partial,*bad_primitive);
+    });
+    assert( error.find("attribute size expect type int64") !=
+            std::string::npos );
+  }
+
+  // a change which can't be applied is skipped and reported
+  {
+    auto bad = dinject::NewDefaultConfigObject();
+    bad->Set("ghost",dinject::Val(dinject::NewDefaultConfigObject()));
+    bad->Set("spot",dinject::Val("@sun"));
+    bad->Set("size",dinject::Val("big"));
+    auto light = NewLight(1.0);
+    light->Set("intensity",dinject::Val("bright"));
+    bad->Set("light",dinject::Val(light));
+    bad->Set("name",dinject::Val("attic"));
+
+    std::vector<dinject::BuildError> errors;
+    assert( !dinject::Apply(room.get(),"room",*partial,*bad,&changed,
+                            &errors) );
+    assert( changed == 1 );
+    assert( room->name == "attic" && room->size == 20 );
+    assert( errors.size() == 4 );
+    for( auto &e : errors ) {
+      if(e.path == "ghost") {
+        assert( e.code == dinject::BuildError::kUnknownClass );
+        assert( e.klass == "ghost" );
+      } else if(e.path == "spot") {
+        // no container to resolve the reference
+        assert( e.code == dinject::BuildError::kTypeMismatch );
+        assert( e.actual == "reference" );
+      } else if(e.path == "size") {
+        assert( e.code == dinject::BuildError::kTypeMismatch );
+        assert( e.expected == "int64" && e.actual == "string" );
+      } else {
+        assert( e.path == "light.intensity" );
+        assert( e.klass == "light" );
+      }
+    }
+
+    // without errors an unknown class is still not counted as unchanged
+    auto ghost = dinject::NewDefaultConfigObject();
+    ghost->Set("ghost",dinject::Val(dinject::NewDefaultConfigObject()));
+    assert( !dinject::Apply(room.get(),"room",*partial,*ghost,&changed) );
+    assert( changed == 0 );
+  }
+
+  // a reference is resolved by the container the object was built with
+  {
+    dinject::Container container;
+    container.Register("sun","light",NewLight(9.0));
+    auto spot = dinject::NewDefaultConfigObject();
+    spot->Set("spot",dinject::Val("@sun"));
+    std::vector<dinject::BuildError> errors;
+    assert( dinject::Apply(room.get(),"room",*partial,*spot,&changed,
+                           &errors,&container) );
+    assert( errors.empty() && changed == 1 );
+    assert( room->spot && room->spot->intensity == 9.0 );
+    assert( room->spot == container.Get<Light>("sun") );
+  }
+
+  // wrong class
+  assert( !dinject::Apply(room.get(),"light",*partial,*renamed) );
+  assert( !dinject::Apply(room.get(),"not_found",*partial,*renamed) );
+
+  std::cout<<"tests passed\n";
+  return 0;
+}
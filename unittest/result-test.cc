@@ -0,0 +1,227 @@
+#include "dinject.h"
+#include "result.h"
+
+#include <iostream>
+#include <cstdint>
+#include <string>
+
+struct Position {
+  double x , y;
+
+  Position() : x(), y() {}
+
+  void SetX( double v ) { x = v; }
+  void SetY( double v ) { y = v; }
+};
+
+DINJECT_CLASS(Position) {
+  dinject::Class<Position>("position")
+    .AddPrimitive<double>("x",&Position::SetX)
+    .AddPrimitive<double>("y",&Position::SetY);
+}
+
+struct Engine {
+  std::int64_t power;
+  std::int32_t cylinder;
+
+  Engine() : power(), cylinder() {}
+
+  void SetPower( std::int64_t v ) { power = v; }
+};
+
+DINJECT_CLASS(Engine) {
+  dinject::Class<Engine>("engine")
+    .AddPrimitive<std::int64_t>("power",&Engine::SetPower)
+    .AddField<&Engine::cylinder>("cylinder");
+}
+
+struct Car {
+  std::string name;
+  std::unique_ptr<Engine> engine;
+  Position pos;
+
+  Car() : name(), engine(), pos() {}
+
+  void SetName  ( const std::string& v ) { name = v; }
+  void SetEngine( Engine* v )            { engine.reset(v); }
+  Position* GetPos()                     { return &pos; }
+};
+
+DINJECT_CLASS(Car) {
+  dinject::Class<Car>("car")
+    .AddString        ("name",&Car::SetName)
+    .AddObject<Engine>("engine","engine",&Car::SetEngine)
+    .AddStruct<Position>("pos","position",&Car::GetPos);
+}
+
+static int kTurbineAlive = 0;
+
+struct Turbine {
+  Turbine()  { ++kTurbineAlive; }
+  ~Turbine() { --kTurbineAlive; }
+};
+
+DINJECT_CLASS(Turbine) {
+  dinject::Class<Turbine>("turbine");
+}
+
+// The dep class of the attribute creates objects of another type , so the
+// setter rejects the built object
+struct Plane {
+  std::unique_ptr<Engine> engine;
+
+  void SetEngine( Engine* v ) { engine.reset(v); }
+};
+
+DINJECT_CLASS(Plane) {
+  dinject::Class<Plane>("plane")
+    .AddObject<Engine>("engine","turbine",&Plane::SetEngine);
+}
+
+static std::shared_ptr<dinject::ConfigObject> NewEngine() {
+  auto engine = dinject::NewDefaultConfigObject();
+  engine->Set("power",dinject::Val(300));
+  engine->Set("cylinder",dinject::Val(8));
+  return engine;
+}
+
+static std::shared_ptr<dinject::ConfigObject> NewCar() {
+  auto pos = dinject::NewDefaultConfigObject();
+  pos->Set("x",dinject::Val(1.5));
+  pos->Set("y",dinject::Val(2.5));
+
+  auto car = dinject::NewDefaultConfigObject();
+  car->Set("name",dinject::Val("coupe"));
+  car->Set("engine",dinject::Val(NewEngine()));
+  car->Set("pos",dinject::Val(pos));
+  return car;
+}
+
+static void CheckMismatch( const dinject::Result<Car>& result ,
+                           const char* klass , const char* path ,
+                           const char* expected , const char* actual ) {
+  assert( !result );
+  assert( !result.get() );
+  auto &error = result.error();
+  assert( error.code == dinject::BuildError::kTypeMismatch );
+  assert( error.klass == klass );
+  assert( error.path == path );
+  assert( error.expected == expected );
+  assert( error.actual == actual );
+}
+
+int main() {
+  dinject::Freeze();
+
+  {
+    auto car = dinject::TryNew<Car>("car",*NewCar());
+    assert( car );
+    assert( car.ok() );
+    assert( car->name == "coupe" );
+    assert( car->engine->power == 300 );
+    assert( car->engine->cylinder == 8 );
+    assert( car->pos.x == 1.5 );
+    assert( car->pos.y == 2.5 );
+    auto owned = car.Release();
+    assert( owned && !car.get() );
+  }
+
+  {
+    auto car = dinject::TryNew<Car>("truck",*NewCar());
+    assert( !car );
+    assert( car.error().code == dinject::BuildError::kUnknownClass );
+    assert( car.error().ToString() == "class truck is not registered" );
+  }
+
+  {
+    auto engine = dinject::TryNew<Engine>("car",*NewCar());
+    assert( !engine );
+    assert( engine.error().code == dinject::BuildError::kWrongType );
+    assert( engine.error().klass == "car" );
+  }
+
+  {
+    auto config = NewCar();
+    config->Set("name",dinject::Val(1));
+    CheckMismatch(dinject::TryNew<Car>("car",*config),
+                  "car","name","string","int64");
+  }
+
+  {
+    // primitive attribute with a nested config
+    auto config = NewCar();
+    config->Set("name",dinject::Val(NewEngine()));
+    CheckMismatch(dinject::TryNew<Car>("car",*config),
+                  "car","name","string","object");
+  }
+
+  {
+    // object attribute with a primitive
+    auto config = NewCar();
+    config->Set("engine",dinject::Val(true));
+    CheckMismatch(dinject::TryNew<Car>("car",*config),
+                  "car","engine","engine","bool");
+  }
+
+  {
+    // struct attribute with a primitive
+    auto config = NewCar();
+    config->Set("pos",dinject::Val("here"));
+    CheckMismatch(dinject::TryNew<Car>("car",*config),
+                  "car","pos","position","string");
+  }
+
+  {
+    // nested object , the half built engine is destroyed
+    auto engine = NewEngine();
+    engine->Set("power",dinject::Val("strong"));
+    auto config = NewCar();
+    config->Set("engine",dinject::Val(engine));
+    auto car = dinject::TryNew<Car>("car",*config);
+    CheckMismatch(car,"engine","engine.power","int64","string");
+    assert( car.error().ToString() ==
+            "object engine's attribute engine.power expect type int64 , "
+            "got string" );
+  }
+
+  {
+    // nested field
+    auto engine = NewEngine();
+    engine->Set("cylinder",dinject::Val(2.0));
+    auto config = NewCar();
+    config->Set("engine",dinject::Val(engine));
+    CheckMismatch(dinject::TryNew<Car>("car",*config),
+                  "engine","engine.cylinder","int32","double");
+  }
+
+  {
+    // nested struct
+    auto pos = dinject::NewDefaultConfigObject();
+    pos->Set("y",dinject::Val(false));
+    auto config = NewCar();
+    config->Set("pos",dinject::Val(pos));
+    CheckMismatch(dinject::TryNew<Car>("car",*config),
+                  "position","pos.y","double","bool");
+  }
+
+  {
+    // the nested object rejected by the setter is destroyed , not leaked
+    auto config = dinject::NewDefaultConfigObject();
+    config->Set("engine",dinject::Val(dinject::NewDefaultConfigObject()));
+    auto plane = dinject::TryNew<Plane>("plane",*config);
+    assert( !plane );
+    assert( plane.error().code == dinject::BuildError::kTypeMismatch );
+    assert( plane.error().path == "engine" );
+    assert( plane.error().actual == "object" );
+    assert( kTurbineAlive == 0 );
+  }
+
+  {
+    // New is not affected
+    auto car = dinject::New<Car>("car",*NewCar());
+    assert( car->engine->power == 300 );
+  }
+
+  std::cout<<"tests passed\n";
+  return 0;
+}
@@ -0,0 +1,113 @@
+#include "dinject.h"
+#include "static.h"
+
+#include <iostream>
+#include <cstdint>
+#include <string>
+
+struct Vec2 {
+  double x;
+  double y;
+};
+
+DINJECT_STATIC_CLASS(Vec2) {
+  static constexpr auto attributes = std::make_tuple(
+    dinject::Attr("x",&Vec2::x),
+    dinject::Attr("y",&Vec2::y));
+};
+
+struct Gun {
+  std::int32_t ammo;
+  std::string sound;
+
+  Gun() : ammo(), sound() {}
+
+  void SetSound( const std::string& v ) { sound = "sfx/" + v; }
+};
+
+DINJECT_STATIC_CLASS(Gun) {
+  static constexpr auto attributes = std::make_tuple(
+    dinject::Attr("ammo" ,&Gun::ammo),
+    dinject::Attr("sound",&Gun::SetSound));
+};
+
+struct Soldier {
+  std::int64_t hp;
+  bool alive;
+  float armor;
+  std::string name;
+  Vec2 pos;
+  std::unique_ptr<Gun> gun;
+
+  Soldier() : hp(), alive(), armor(), name(), pos(), gun() {}
+
+  void SetArmor( float v )           { armor = v * 2; }
+  void SetName ( std::string&& v )   { name = std::move(v); }
+  void SetGun  ( Gun* v )            { gun.reset(v); }
+};
+
+DINJECT_STATIC_CLASS(Soldier) {
+  static constexpr auto attributes = std::make_tuple(
+    dinject::Attr("name" ,&Soldier::SetName),
+    dinject::Attr("hp"   ,&Soldier::hp),
+    dinject::Attr("alive",&Soldier::alive),
+    dinject::Attr("armor",&Soldier::SetArmor),
+    dinject::Attr("pos"  ,&Soldier::pos),
+    dinject::Attr("gun"  ,&Soldier::SetGun));
+};
+
+// the lookup table is built at compile time
+typedef dinject::detail::StaticTable<Soldier> SoldierTable;
+static_assert(SoldierTable::kSize == 6);
+static_assert(SoldierTable::Find("name") == 0);
+static_assert(SoldierTable::Find("gun") == 5);
+static_assert(SoldierTable::Find("alive") == 2);
+static_assert(SoldierTable::Find("none") == SoldierTable::kNotFound);
+static_assert(SoldierTable::kSorted[0].name == "alive");
+static_assert(!dinject::detail::HasStaticClass<std::string>::value);
+
+int main() {
+  auto config = dinject::NewDefaultConfigObject();
+  config->Set("hp",dinject::Val(80));
+  config->Set("alive",dinject::Val(true));
+  config->Set("armor",dinject::Val(1.5));
+  config->Set("name",dinject::Val("ryan"));
+  config->Set("unknown",dinject::Val(1));
+  {
+    auto pos = dinject::NewDefaultConfigObject();
+    pos->Set("x",dinject::Val(3.0));
+    pos->Set("y",dinject::Val(4.0));
+    config->Set("pos",dinject::Val(pos));
+  }
+  {
+    auto gun = dinject::NewDefaultConfigObject();
+    gun->Set("ammo",dinject::Val(30));
+    gun->Set("sound",dinject::Val("bang"));
+    config->Set("gun",dinject::Val(gun));
+  }
+
+  // no registry is involved
+  assert( !dinject::detail::GetKlass("soldier") );
+
+  auto s = dinject::New<Soldier>(*config);
+  assert( s->hp == 80 );
+  assert( s->alive );
+  assert( s->armor == 3.0f );
+  assert( s->name == "ryan" );
+  assert( s->pos.x == 3.0 && s->pos.y == 4.0 );
+  assert( s->gun );
+  assert( s->gun->ammo == 30 );
+  assert( s->gun->sound == "sfx/bang" );
+
+  // inject into an existing object
+  {
+    Vec2 v{0,0};
+    auto cfg = dinject::NewDefaultConfigObject();
+    cfg->Set("y",dinject::Val(9.0));
+    dinject::Build(&v,*cfg);
+    assert( v.x == 0 && v.y == 9.0 );
+  }
+
+  std::cout<<"tests passed\n";
+  return 0;
+}
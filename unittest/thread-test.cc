@@ -0,0 +1,136 @@
+#include "dinject.h"
+#include "plan.h"
+
+#include <iostream>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct Material {
+  std::string shader;
+  double roughness;
+
+  Material() : shader(), roughness() {}
+
+  void SetShader   ( const std::string& v ) { shader = v; }
+  void SetRoughness( double v )             { roughness = v; }
+};
+
+DINJECT_CLASS(Material) {
+  dinject::Class<Material>("material")
+    .AddString           ("shader",&Material::SetShader)
+    .AddPrimitive<double>("roughness",&Material::SetRoughness);
+}
+
+struct Transform {
+  double x;
+  double y;
+
+  Transform() : x(), y() {}
+
+  void SetX( double v ) { x = v; }
+  void SetY( double v ) { y = v; }
+};
+
+DINJECT_CLASS(Transform) {
+  dinject::Class<Transform>("transform")
+    .AddPrimitive<double>("x",&Transform::SetX)
+    .AddPrimitive<double>("y",&Transform::SetY);
+}
+
+struct Mesh {
+  std::int64_t id;
+  Transform transform;
+  std::unique_ptr<Material> material;
+
+  Mesh() : id(), transform(), material() {}
+
+  void SetId( std::int64_t v )  { id = v; }
+  void SetMaterial( Material* v ) { material.reset(v); }
+  Transform* GetTransform() { return &transform; }
+};
+
+DINJECT_CLASS(Mesh) {
+  dinject::Class<Mesh>("mesh")
+    .AddPrimitive<std::int64_t>("id",&Mesh::SetId)
+    .AddStruct<Transform>      ("transform","transform",&Mesh::GetTransform)
+    .AddObject<Material>       ("material","material",&Mesh::SetMaterial);
+}
+
+static std::shared_ptr<dinject::ConfigObject> NewMeshConfig( int id ) {
+  auto material = dinject::NewDefaultConfigObject();
+  material->Set("shader",dinject::Val("pbr_shader_" + std::to_string(id)));
+  material->Set("roughness",dinject::Val(0.5));
+
+  auto transform = dinject::NewDefaultConfigObject();
+  transform->Set("x",dinject::Val(static_cast<double>(id)));
+  transform->Set("y",dinject::Val(-static_cast<double>(id)));
+
+  auto mesh = dinject::NewDefaultConfigObject();
+  mesh->Set("id",dinject::Val(id));
+  mesh->Set("transform",dinject::Val(transform));
+  mesh->Set("material",dinject::Val(material));
+  return mesh;
+}
+
+static bool Check( const Mesh& mesh , int id ) {
+  return mesh.id == id &&
+         mesh.transform.x == id &&
+         mesh.transform.y == -id &&
+         mesh.material &&
+         mesh.material->shader == "pbr_shader_" + std::to_string(id) &&
+         mesh.material->roughness == 0.5;
+}
+
+int main() {
+  assert( !dinject::detail::IsFrozen() );
+  dinject::Freeze();
+  assert( dinject::detail::IsFrozen() );
+  dinject::Freeze(); // freeze twice is fine
+
+  assert( dinject::detail::GetKlass("mesh")->sealed() );
+  assert( dinject::detail::GetKlass("material")->sealed() );
+
+  const int kThread = 16;
+  const int kConfig = 8;
+  const int kLoop   = 500;
+
+  // configs and plans are shared read only by all threads
+  std::vector<std::shared_ptr<dinject::ConfigObject>> configs;
+  std::vector<std::unique_ptr<dinject::Plan>> plans;
+  for( int i = 0 ; i < kConfig ; ++i ) {
+    configs.push_back(NewMeshConfig(i));
+    plans.emplace_back(new dinject::Plan("mesh",*configs.back()));
+  }
+
+  std::atomic<int> failure(0);
+  std::atomic<int> built(0);
+  std::vector<std::thread> threads;
+
+  for( int t = 0 ; t < kThread ; ++t ) {
+    threads.emplace_back([&,t]() {
+      for( int i = 0 ; i < kLoop ; ++i ) {
+        int id = (t + i) % kConfig;
+
+        auto a = dinject::New<Mesh>("mesh",*configs[id]);
+        if(!a || !Check(*a,id)) ++failure;
+
+        auto b = plans[id]->New<Mesh>();
+        if(!b || !Check(*b,id)) ++failure;
+
+        if(dinject::detail::GetKlass("material") == NULL) ++failure;
+        built += 2;
+      }
+    });
+  }
+
+  for( auto &t : threads ) t.join();
+
+  assert( failure == 0 );
+  assert( built == kThread * kLoop * 2 );
+
+  std::cout<<"tests passed\n";
+  return 0;
+}
@@ -0,0 +1,138 @@
+#include "dinject.h"
+#include "trace.h"
+
+#include <iostream>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+struct Engine {
+  std::int64_t power;
+
+  Engine() : power() {}
+
+  void SetPower( std::int64_t v ) { power = v; }
+};
+
+DINJECT_CLASS(Engine) {
+  dinject::Class<Engine>("engine")
+    .AddPrimitive<std::int64_t>("power",&Engine::SetPower);
+}
+
+struct Car {
+  std::string name;
+  std::unique_ptr<Engine> engine;
+
+  Car() : name(), engine() {}
+
+  void SetName  ( const std::string& v ) { name = v; }
+  void SetEngine( Engine* v )            { engine.reset(v); }
+};
+
+DINJECT_CLASS(Car) {
+  dinject::Class<Car>("car")
+    .AddString     ("name",&Car::SetName)
+    .AddObject<Engine>("engine","engine",&Car::SetEngine);
+}
+
+static std::size_t Count( const std::string& text , const char* pattern ) {
+  std::size_t count = 0;
+  for( auto pos = text.find(pattern) ; pos != std::string::npos ;
+            pos = text.find(pattern,pos+1) ) {
+    ++count;
+  }
+  return count;
+}
+
+// Flush the trace into a string
+static std::string Flush( std::size_t* count ) {
+  auto file = std::tmpfile();
+  assert( file );
+  *count = dinject::FlushTrace(file);
+  std::string text;
+  std::rewind(file);
+  for( int c ; (c = std::fgetc(file)) != EOF ; ) text.push_back(char(c));
+  std::fclose(file);
+  return text;
+}
+
+int main() {
+  dinject::Freeze();
+
+  auto engine = dinject::NewDefaultConfigObject();
+  engine->Set("power",dinject::Val(300));
+
+  auto car = dinject::NewDefaultConfigObject();
+  car->Set("name",dinject::Val("coupe"));
+  car->Set("engine",dinject::Val(engine));
+
+  std::size_t count;
+  if(!dinject::TraceEnabled()) {
+    // compiled out , nothing is recorded
+    dinject::StartTrace();
+    dinject::New<Car>("car",*car);
+    dinject::StopTrace();
+    auto text = Flush(&count);
+    assert( count == 0 );
+    assert( text == "{\"traceEvents\":[]}\n" );
+    std::cout<<"tests passed\n";
+    return 0;
+  }
+
+  // not started , nothing is recorded
+  dinject::New<Car>("car",*car);
+  Flush(&count);
+  assert( count == 0 );
+
+  {
+    dinject::StartTrace();
+    auto c = dinject::New<Car>("car",*car);
+    dinject::StopTrace();
+    assert( c->engine->power == 300 );
+
+    auto text = Flush(&count);
+    // new car , object engine , new engine , setter power , setter engine
+    // and setter name
+    assert( count == 12 );
+    assert( Count(text,"\"ph\":\"B\"") == 6 );
+    assert( Count(text,"\"ph\":\"E\"") == 6 );
+    assert( Count(text,"\"name\":\"car\",\"cat\":\"new\"") == 2 );
+    assert( Count(text,"\"name\":\"engine\",\"cat\":\"new\"") == 2 );
+    assert( Count(text,"\"name\":\"engine\",\"cat\":\"object\"") == 2 );
+    assert( Count(text,"\"name\":\"power\",\"cat\":\"setter\"") == 2 );
+    assert( text.find("{\"traceEvents\":[") == 0 );
+
+    // flushed events are gone
+    Flush(&count);
+    assert( count == 0 );
+  }
+
+  {
+    // every thread has its own tid
+    dinject::StartTrace();
+    dinject::New<Car>("car",*car);
+    std::thread t([&]() { dinject::New<Car>("car",*car); });
+    t.join();
+    dinject::StopTrace();
+    auto text = Flush(&count);
+    assert( count == 24 );
+    assert( Count(text,"\"tid\":1}") == 12 );
+    assert( Count(text,"\"tid\":2}") == 12 );
+  }
+
+  {
+    // a full ring drops whole spans
+    const std::size_t kCount = dinject::kTraceRingSize / 6 + 100;
+    dinject::StartTrace();
+    for( std::size_t i = 0 ; i < kCount ; ++i ) dinject::New<Car>("car",*car);
+    dinject::StopTrace();
+    assert( dinject::TraceDropped() > 0 );
+    auto text = Flush(&count);
+    assert( count <= dinject::kTraceRingSize );
+    assert( Count(text,"\"ph\":\"B\"") == Count(text,"\"ph\":\"E\"") );
+  }
+
+  std::cout<<"tests passed\n";
+  return 0;
+}
@@ -0,0 +1,206 @@
+#include "dinject.h"
+#include "validate.h"
+
+#include <iostream>
+#include <cstdint>
+#include <string>
+
+struct Position {
+  double x , y;
+
+  Position() : x(), y() {}
+
+  void SetX( double v ) { x = v; }
+  void SetY( double v ) { y = v; }
+};
+
+DINJECT_CLASS(Position) {
+  dinject::Class<Position>("position")
+    .AddPrimitive<double>("x",&Position::SetX)
+    .AddPrimitive<double>("y",&Position::SetY);
+}
+
+struct Ghost {};
+
+struct Engine {
+  std::int64_t power;
+  std::int32_t cylinder;
+
+  Engine() : power(), cylinder() {}
+
+  void SetPower( std::int64_t v ) { power = v; }
+};
+
+DINJECT_CLASS(Engine) {
+  dinject::Class<Engine>("engine")
+    .AddPrimitive<std::int64_t>("power",&Engine::SetPower)
+    .AddField<&Engine::cylinder>("cylinder");
+}
+
+struct Vehicle {
+  std::string name;
+
+  void SetName( const std::string& v ) { name = v; }
+};
+
+DINJECT_CLASS(Vehicle) {
+  dinject::Class<Vehicle>("vehicle")
+    .AddString("name",&Vehicle::SetName);
+}
+
+struct Car : public Vehicle {
+  std::unique_ptr<Engine> engine;
+  std::unique_ptr<Ghost> ghost;
+  std::shared_ptr<Engine> spare;
+  Position pos;
+
+  void SetEngine( Engine* v ) { engine.reset(v); }
+  void SetGhost ( Ghost* v )  { ghost.reset(v); }
+  void SetSpare ( std::shared_ptr<Engine> v ) { spare = std::move(v); }
+  Position* GetPos()          { return &pos; }
+};
+
+DINJECT_CLASS(Car) {
+  dinject::Class<Car>("car")
+    .AddObject<Engine>  ("engine","engine",&Car::SetEngine)
+    .AddObject<Ghost>   ("ghost","ghost",&Car::SetGhost)   // not registered
+    .AddShared<Engine>  ("spare","engine",&Car::SetSpare)
+    .AddStruct<Position>("pos","position",&Car::GetPos)
+    .Inherit("vehicle");
+}
+
+static std::shared_ptr<dinject::ConfigObject> NewCar() {
+  auto engine = dinject::NewDefaultConfigObject();
+  engine->Set("power",dinject::Val(300));
+  engine->Set("cylinder",dinject::Val(8));
+
+  auto pos = dinject::NewDefaultConfigObject();
+  pos->Set("x",dinject::Val(1.5));
+  pos->Set("y",dinject::Val(2.5));
+
+  auto car = dinject::NewDefaultConfigObject();
+  car->Set("name",dinject::Val("coupe"));        // inherited
+  car->Set("engine",dinject::Val(engine));
+  car->Set("pos",dinject::Val(pos));
+  return car;
+}
+
+static const dinject::BuildError* Find(
+    const std::vector<dinject::BuildError>& errors , const char* path ) {
+  for( auto &e : errors ) {
+    if(e.path == path) return &e;
+  }
+  return NULL;
+}
+
+int main() {
+  dinject::Freeze();
+
+  {
+    auto config = NewCar();
+    assert( dinject::Validate("car",*config).empty() );
+
+    // an integer is accepted by a double attribute , as New does
+    auto pos = dinject::NewDefaultConfigObject();
+    pos->Set("x",dinject::Val(3));
+    config->Set("pos",dinject::Val(pos));
+    assert( dinject::Validate("car",*config).empty() );
+    assert( dinject::New<Position>("position",*pos)->x == 3.0 );
+  }
+
+  {
+    // a reference to a container instance is resolved by Container::New ,
+    // only for a shared attribute
+    auto config = NewCar();
+    config->Set("spare",dinject::Val("@engine"));
+    assert( dinject::Validate("car",*config,true).empty() );
+
+    auto errors = dinject::Validate("car",*config);
+    assert( errors.size() == 1 );
+    assert( errors[0].code == dinject::BuildError::kTypeMismatch );
+    assert( errors[0].path == "spare" && errors[0].actual == "string" );
+
+    config->Set("engine",dinject::Val("@engine"));
+    errors = dinject::Validate("car",*config,true);
+    assert( errors.size() == 1 );
+    assert( errors[0].code == dinject::BuildError::kTypeMismatch );
+    assert( errors[0].path == "engine" );
+    assert( errors[0].expected == "engine" && errors[0].actual == "string" );
+  }
+
+  {
+    auto errors = dinject::Validate("truck",*NewCar());
+    assert( errors.size() == 1 );
+    assert( errors[0].code == dinject::BuildError::kUnknownClass );
+    assert( errors[0].ToString() == "class truck is not registered" );
+  }
+
+  {
+    // every problem is reported , not only the first one
+    auto engine = dinject::NewDefaultConfigObject();
+    engine->Set("power",dinject::Val("strong"));
+    engine->Set("cylinder",dinject::Val(2.0));
+    engine->Set("turbo",dinject::Val(true));
+
+    auto pos = dinject::NewDefaultConfigObject();
+    pos->Set("y",dinject::Val(false));
+
+    auto config = dinject::NewDefaultConfigObject();
+    config->Set("name",dinject::Val(1));
+    config->Set("engine",dinject::Val(engine));
+    config->Set("pos",dinject::Val(pos));
+    config->Set("ghost",dinject::Val(dinject::NewDefaultConfigObject()));
+    config->Set("wheels",dinject::Val(4));
+
+    auto errors = dinject::Validate("car",*config);
+    assert( errors.size() == 7 );
+
+    auto e = Find(errors,"name");
+    assert( e && e->code == dinject::BuildError::kTypeMismatch );
+    assert( e->klass == "car" );
+    assert( e->expected == "string" && e->actual == "int64" );
+
+    e = Find(errors,"engine.power");
+    assert( e && e->code == dinject::BuildError::kTypeMismatch );
+    assert( e->klass == "engine" );
+    assert( e->expected == "int64" && e->actual == "string" );
+
+    e = Find(errors,"engine.cylinder");
+    assert( e && e->code == dinject::BuildError::kTypeMismatch );
+    assert( e->expected == "int32" && e->actual == "double" );
+
+    e = Find(errors,"engine.turbo");
+    assert( e && e->code == dinject::BuildError::kUnknownKey );
+    assert( e->ToString() == "object engine has no attribute engine.turbo" );
+
+    e = Find(errors,"pos.y");
+    assert( e && e->code == dinject::BuildError::kTypeMismatch );
+    assert( e->klass == "position" );
+
+    e = Find(errors,"ghost");
+    assert( e && e->code == dinject::BuildError::kUnknownClass );
+    assert( e->klass == "ghost" );
+    assert( e->ToString() ==
+            "class ghost of attribute ghost is not registered" );
+
+    e = Find(errors,"wheels");
+    assert( e && e->code == dinject::BuildError::kUnknownKey );
+    assert( e->klass == "car" );
+  }
+
+  {
+    // nested config for a primitive and primitive for an object
+    auto config = NewCar();
+    config->Set("name",dinject::Val(dinject::NewDefaultConfigObject()));
+    config->Set("engine",dinject::Val(3.0));
+    config->Set("pos",dinject::Val("here"));
+    auto errors = dinject::Validate("car",*config);
+    assert( errors.size() == 3 );
+    assert( Find(errors,"name")->actual == "object" );
+    assert( Find(errors,"engine")->expected == "engine" );
+    assert( Find(errors,"pos")->expected == "position" );
+  }
+
+  std::cout<<"tests passed\n";
+  return 0;
+}